@@ -0,0 +1,735 @@
+/*
+	bigint
+	
+	Copyright (c) 2025 Royal_X (MIT License)
+ 
+ 	https://github.com/RoyalXXX
+  	https://royalxxx.itch.io
+   	https://sourceforge.net/u/royal-x
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+	
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// bigint_bench: times every public operation of bigint.h over operand sizes from 1 to 10^7
+// digits and prints the results as JSON. With --compare it reads two such files and reports
+// the operations that got slower.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bigint.h"
+
+// An operation prepared for operands of a given size
+using Operation = std::function<void()>;
+
+struct Benchmark
+{
+    std::string name;
+    std::size_t limit; // largest operand size, in digits, that finishes in reasonable time
+    std::function<Operation(std::size_t)> setup;
+};
+
+struct Result
+{
+    std::string name;
+    std::size_t digits;
+    std::uint64_t iterations;
+    double ns_per_op;
+};
+
+// Limits by the complexity of the operation
+static constexpr std::size_t LINEAR = 10000000;
+static constexpr std::size_t MULTIPLY = 1000000;
+static constexpr std::size_t QUADRATIC = 100000;
+static constexpr std::size_t SLOW = 10000;
+static constexpr std::size_t VERY_SLOW = 1000;
+static constexpr std::size_t SEARCH = 100; // a slow test per candidate
+static constexpr std::size_t FIXED = 1000; // Fixed holds up to 1233 digits
+static constexpr std::size_t CACHE_BYTES = std::size_t{1} << 30;
+
+using Fixed = FixedBigInt<4096>;
+
+static const std::vector<std::size_t> SIZES{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+
+static std::mt19937_64 rng{20250101};
+
+// A byte of every result is read through a volatile access, so the work is not optimized away
+static volatile unsigned char sink;
+
+template <typename T>
+static void Keep(const T& x)
+{
+    sink = sink ^ *reinterpret_cast<const volatile unsigned char*>(&x);
+}
+
+static std::string RandomDigits(const std::size_t digits)
+{
+    std::string s(digits, '0');
+    s[0] = static_cast<char>('1' + rng() % 9);
+    for (std::size_t i{1}; i < digits; ++i)
+        s[i] = static_cast<char>('0' + rng() % 10);
+    return s;
+}
+static BigInt RandomInt(const std::size_t digits)
+{
+    return BigInt(RandomDigits(std::max<std::size_t>(digits, 1)));
+}
+static BigFrac RandomFrac(const std::size_t digits)
+{
+    return BigFrac(RandomInt(digits), RandomInt(digits));
+}
+
+// Arguments of the functions taking an int, chosen so that the result has about d digits
+static int FactorialArgument(const std::size_t d)
+{
+    double digits{};
+    int n{1};
+    while (digits < static_cast<double>(d))
+        digits += std::log10(++n);
+    return n;
+}
+static int FibonacciArgument(const std::size_t d)
+{
+    return std::max(1, static_cast<int>(static_cast<double>(d) / std::log10((1 + std::sqrt(5.)) / 2)));
+}
+static int BinomialArgument(const std::size_t d)
+{
+    return std::max(2, static_cast<int>(static_cast<double>(d) / std::log10(2.)));
+}
+static int HarmonicArgument(const std::size_t d)
+{
+    return std::max(1, static_cast<int>(static_cast<double>(d) / std::log10(std::exp(1.))));
+}
+
+template <typename F>
+static Benchmark Unary(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d);
+        return [f, x]{Keep(f(x));};
+    }};
+}
+template <typename F>
+static Benchmark Binary(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d), y = RandomInt(d);
+        return [f, x, y]{Keep(f(x, y));};
+    }};
+}
+template <typename F>
+static Benchmark FracUnary(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d);
+        return [f, x]{Keep(f(x));};
+    }};
+}
+template <typename F>
+static Benchmark FracBinary(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d), y = RandomFrac(d);
+        return [f, x, y]{Keep(f(x, y));};
+    }};
+}
+template <typename F>
+static Benchmark FixedUnary(const std::string& name, const F& f)
+{
+    return {name, FIXED, [f](std::size_t d) -> Operation
+    {
+        auto x = Fixed(RandomInt(d));
+        return [f, x]{Keep(f(x));};
+    }};
+}
+template <typename F>
+static Benchmark FixedBinary(const std::string& name, const F& f)
+{
+    return {name, FIXED, [f](std::size_t d) -> Operation
+    {
+        auto x = Fixed(RandomInt(d)), y = Fixed(RandomInt(d));
+        return [f, x, y]{Keep(f(x, y));};
+    }};
+}
+template <typename F>
+static Benchmark Argument(const std::string& name, const std::size_t limit, int (*argument)(std::size_t), const F& f)
+{
+    return {name, limit, [f, argument](std::size_t d) -> Operation
+    {
+        auto n = argument(d);
+        return [f, n]{Keep(f(n));};
+    }};
+}
+// Batches of 16 pairs of operands
+template <typename F>
+static Benchmark Batch(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        auto x = std::make_shared<std::vector<BigInt>>(), y = std::make_shared<std::vector<BigInt>>();
+        for (int i{}; i < 16; ++i)
+        {
+            x->push_back(RandomInt(d));
+            y->push_back(RandomInt(d));
+        }
+        auto out = std::make_shared<std::vector<BigInt>>(16);
+        return [f, x, y, out]{f(x->data(), y->data(), out->data(), x->size()); Keep(*out);};
+    }};
+}
+// Reductions over 100 operands sharing the digits
+template <typename F>
+static Benchmark Reduction(const std::string& name, const std::size_t limit, const F& f)
+{
+    return {name, limit, [f](std::size_t d) -> Operation
+    {
+        std::vector<BigInt> v;
+        for (int i{}; i < 100; ++i)
+            v.push_back(RandomInt(std::max<std::size_t>(d / 100, 1)));
+        return [f, v]{Keep(f(v));};
+    }};
+}
+
+static std::vector<Benchmark> Benchmarks()
+{
+    std::vector<Benchmark> b;
+    // BigInt arithmetic
+    b.push_back(Binary("BigInt/Add", LINEAR, [](const BigInt& x, const BigInt& y){return x + y;}));
+    b.push_back(Binary("BigInt/Subtract", LINEAR, [](const BigInt& x, const BigInt& y){return x - y;}));
+    b.push_back(Unary("BigInt/Minus", LINEAR, [](const BigInt& x){return -x;}));
+    b.push_back(Binary("BigInt/Multiply", MULTIPLY, [](const BigInt& x, const BigInt& y){return x * y;}));
+    b.push_back({"BigInt/Divide", QUADRATIC, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(2 * d), y = RandomInt(d);
+        return [x, y]{Keep(x / y);};
+    }});
+    b.push_back({"BigInt/Remainder", QUADRATIC, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(2 * d), y = RandomInt(d);
+        return [x, y]{Keep(x % y);};
+    }});
+    b.push_back({"BigInt/Pow", MULTIPLY, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d / 16);
+        return [x]{Keep(x ^ 16);};
+    }});
+    b.push_back(Unary("BigInt/Abs", LINEAR, [](const BigInt& x){return Abs(x);}));
+    b.push_back(Argument("BigInt/Factorial", MULTIPLY, FactorialArgument, [](int n){return Factorial(n);}));
+    b.push_back(Binary("BigInt/GCD", SLOW, [](const BigInt& x, const BigInt& y){return GCD(x, y);}));
+    b.push_back(Binary("BigInt/LCM", SLOW, [](const BigInt& x, const BigInt& y){return LCM(x, y);}));
+    b.push_back(Unary("BigInt/ISqrt", SLOW, [](const BigInt& x){return ISqrt(x);}));
+    b.push_back(Argument("BigInt/Fibonacci", SLOW, FibonacciArgument, [](int n){return Fibonacci(n);}));
+    b.push_back(Argument("BigInt/Binomial", SLOW, BinomialArgument, [](int n){return Binomial(n, n / 2);}));
+    b.push_back(Unary("BigInt/EvenQ", LINEAR, [](const BigInt& x){return EvenQ(x);}));
+    b.push_back(Unary("BigInt/OddQ", LINEAR, [](const BigInt& x){return OddQ(x);}));
+    b.push_back(Unary("BigInt/IntegerLength", LINEAR, [](const BigInt& x){return IntegerLength(x);}));
+    b.push_back(Unary("BigInt/Approx", LINEAR, [](const BigInt& x){return Approx(x);}));
+    b.push_back({"BigInt/AddMul", MULTIPLY, [](std::size_t d) -> Operation
+    {
+        auto x = std::make_shared<BigInt>(RandomInt(2 * d));
+        auto y = RandomInt(d), z = RandomInt(d);
+        return [x, y, z]{Keep(AddMul(*x, y, z));};
+    }});
+    b.push_back({"BigInt/SubMul", MULTIPLY, [](std::size_t d) -> Operation
+    {
+        auto x = std::make_shared<BigInt>(RandomInt(2 * d));
+        auto y = RandomInt(d), z = RandomInt(d);
+        return [x, y, z]{Keep(SubMul(*x, y, z));};
+    }});
+    b.push_back({"BigInt/MulMod", SLOW, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d), y = RandomInt(d), m = RandomInt(d);
+        return [x, y, m]{Keep(MulMod(x, y, m));};
+    }});
+    b.push_back({"BigInt/PowerMod", VERY_SLOW, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d), e = RandomInt(d), m = RandomInt(d);
+        if (EvenQ(m))
+            m += BigInt("1");
+        return [x, e, m]{Keep(PowerMod(x, e, m));};
+    }});
+    b.push_back({"BigInt/PrimeQ", VERY_SLOW, [](std::size_t d) -> Operation
+    {
+        // Random odd numbers, mostly rejected by trial division or the first strong test
+        auto x = RandomInt(d);
+        if (EvenQ(x))
+            x += BigInt("1");
+        return [x]{Keep(PrimeQ(x));};
+    }});
+    b.push_back(Unary("BigInt/NextPrime", SEARCH, [](const BigInt& x){return NextPrime(x);}));
+    b.push_back(Unary("BigInt/PrevPrime", SEARCH, [](const BigInt& x){return PrevPrime(x + BigInt("3"));}));
+    b.push_back({"BigInt/FactorInteger", SEARCH, [](std::size_t d) -> Operation
+    {
+        // Products of 10-digit primes, which rho splits without falling back to ECM
+        BigInt x{"1"};
+        while (x.get_value().length() + 10 <= std::max<std::size_t>(d, 10))
+            x *= NextPrime(RandomInt(10));
+        if (x.get_value() == "1")
+            x = RandomInt(d);
+        return [x]{Keep(FactorInteger(x));};
+    }});
+    b.push_back(Unary("BigInt/RandomBelow", LINEAR, [](const BigInt& x){return RandomBelow(x);}));
+    // Comparisons of equal-length operands that differ only in the last digit
+    auto pair = [](std::size_t d)
+    {
+        auto s = RandomDigits(d);
+        auto t = s;
+        t.back() = s.back() == '9' ? '8' : static_cast<char>(s.back() + 1);
+        return std::make_pair(BigInt(s), BigInt(t));
+    };
+    auto compare = [pair](const std::string& name, auto f)
+    {
+        return Benchmark{name, LINEAR, [pair, f](std::size_t d) -> Operation
+        {
+            auto p = pair(d);
+            return [p, f]{Keep(f(p.first, p.second));};
+        }};
+    };
+    b.push_back(compare("BigInt/EqualQ", [](const BigInt& x, const BigInt& y){return x == y;}));
+    b.push_back(compare("BigInt/NotEqualQ", [](const BigInt& x, const BigInt& y){return x != y;}));
+    b.push_back(compare("BigInt/GreaterQ", [](const BigInt& x, const BigInt& y){return x > y;}));
+    b.push_back(compare("BigInt/LessQ", [](const BigInt& x, const BigInt& y){return x < y;}));
+    b.push_back(compare("BigInt/GreaterEqualQ", [](const BigInt& x, const BigInt& y){return x >= y;}));
+    b.push_back(compare("BigInt/LessEqualQ", [](const BigInt& x, const BigInt& y){return x <= y;}));
+    // Bitwise operations
+    b.push_back(Binary("BigInt/BitAnd", QUADRATIC, [](const BigInt& x, const BigInt& y){return x & y;}));
+    b.push_back(Binary("BigInt/BitOr", QUADRATIC, [](const BigInt& x, const BigInt& y){return x | y;}));
+    b.push_back(Binary("BigInt/BitXor", QUADRATIC, [](const BigInt& x, const BigInt& y){return BitXor(x, y);}));
+    b.push_back(Unary("BigInt/BitNot", LINEAR, [](const BigInt& x){return ~x;}));
+    b.push_back(Unary("BigInt/BitShiftLeft", LINEAR, [](const BigInt& x){return x << 64;}));
+    b.push_back(Unary("BigInt/BitShiftRight", LINEAR, [](const BigInt& x){return x >> 64;}));
+    b.push_back(Unary("BigInt/BitLength", QUADRATIC, [](const BigInt& x){return BitLength(x);}));
+    b.push_back(Unary("BigInt/PopCount", QUADRATIC, [](const BigInt& x){return PopCount(x);}));
+    b.push_back(Unary("BigInt/TestBit", QUADRATIC, [](const BigInt& x){return TestBit(x, 100);}));
+    // Reductions and batches
+    b.push_back(Reduction("BigInt/Product", MULTIPLY, [](const std::vector<BigInt>& v){return Product(v);}));
+    b.push_back(Reduction("BigInt/Sum", LINEAR, [](const std::vector<BigInt>& v){return Sum(v);}));
+    b.push_back(Reduction("BigInt/LCMList", SLOW, [](const std::vector<BigInt>& v){return LCM(v);}));
+    b.push_back(Batch("BigInt/AddN", MULTIPLY, [](const BigInt* x, const BigInt* y, BigInt* out, std::size_t n){AddN(x, y, out, n);}));
+    b.push_back(Batch("BigInt/MulN", QUADRATIC, [](const BigInt* x, const BigInt* y, BigInt* out, std::size_t n){MulN(x, y, out, n);}));
+    b.push_back(Batch("BigInt/ModN", SLOW, [](const BigInt* x, const BigInt* y, BigInt* out, std::size_t n){ModN(x, y, out, n);}));
+    // Parsing and printing
+    b.push_back({"BigInt/Parse", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto s = RandomDigits(d);
+        return [s]{Keep(BigInt(s));};
+    }});
+    b.push_back({"BigInt/FromChars", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto s = RandomDigits(d);
+        return [s]{BigInt x; FromChars(s.data(), s.data() + s.size(), x); Keep(x);};
+    }});
+    b.push_back({"BigInt/FromCharsHex", QUADRATIC, [](std::size_t d) -> Operation
+    {
+        auto s = RandomDigits(d);
+        return [s]{BigInt x; FromChars(s.data(), s.data() + s.size(), x, 16); Keep(x);};
+    }});
+    b.push_back({"BigInt/Print", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d);
+        return [x]{std::ostringstream out; out << x; Keep(out);};
+    }});
+    b.push_back({"BigInt/ToChars", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d);
+        auto buffer = std::make_shared<std::string>(FormattedSize(x), '\0');
+        return [x, buffer]{Keep(ToChars(&(*buffer)[0], &(*buffer)[0] + buffer->size(), x));};
+    }});
+    b.push_back({"BigInt/ToCharsHex", QUADRATIC, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d);
+        auto buffer = std::make_shared<std::string>(FormattedSize(x, 16), '\0');
+        return [x, buffer]{Keep(ToChars(&(*buffer)[0], &(*buffer)[0] + buffer->size(), x, 16));};
+    }});
+    b.push_back(Unary("BigInt/FormattedSize", LINEAR, [](const BigInt& x){return FormattedSize(x);}));
+#ifdef __cpp_lib_format
+    b.push_back(Unary("BigInt/Format", LINEAR, [](const BigInt& x){return std::format("{:,}", x);}));
+#endif
+    // Binary serialization
+    b.push_back(Unary("BigInt/BinarySize", LINEAR, [](const BigInt& x){return BinarySize(x);}));
+    b.push_back({"BigInt/WriteBinary", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d);
+        auto buffer = std::make_shared<std::string>(BinarySize(x), '\0');
+        return [x, buffer]{Keep(WriteBinary(&(*buffer)[0], x));};
+    }});
+    b.push_back({"BigInt/ReadBigInt", LINEAR, [](std::size_t d) -> Operation
+    {
+        std::ostringstream out;
+        WriteBinary(out, RandomInt(d));
+        auto data = out.str();
+        return [data]{std::istringstream in(data); Keep(ReadBigInt(in));};
+    }});
+    auto view = [](std::size_t d)
+    {
+        auto data = std::make_shared<std::string>(BinarySize(RandomInt(d)) + BinarySize(RandomInt(d)), '\0');
+        auto p = WriteBinary(&(*data)[0], RandomInt(d));
+        WriteBinary(p, RandomInt(d));
+        return data;
+    };
+    b.push_back({"BigIntView/ToBigInt", LINEAR, [view](std::size_t d) -> Operation
+    {
+        auto data = view(d);
+        return [data]{Keep(BigInt(BigIntView(data->data(), data->data() + data->size())));};
+    }});
+    b.push_back({"BigIntView/Add", LINEAR, [view](std::size_t d) -> Operation
+    {
+        auto data = view(d);
+        BigIntView x(data->data(), data->data() + data->size());
+        BigIntView y(x.get_end(), data->data() + data->size());
+        return [data, x, y]{Keep(x + y);};
+    }});
+    b.push_back({"BigIntView/Multiply", MULTIPLY, [view](std::size_t d) -> Operation
+    {
+        auto data = view(d);
+        BigIntView x(data->data(), data->data() + data->size());
+        BigIntView y(x.get_end(), data->data() + data->size());
+        return [data, x, y]{Keep(x * y);};
+    }});
+    b.push_back({"BigIntView/LessQ", LINEAR, [view](std::size_t d) -> Operation
+    {
+        auto data = view(d);
+        BigIntView x(data->data(), data->data() + data->size());
+        BigIntView y(x.get_end(), data->data() + data->size());
+        return [data, x, y]{Keep(x < y);};
+    }});
+    auto files = [](std::size_t d)
+    {
+        return std::make_shared<std::pair<BigIntFile, BigIntFile>>(BigIntFile(RandomInt(d)), BigIntFile(RandomInt(d)));
+    };
+    b.push_back({"BigIntFile/Add", LINEAR, [files](std::size_t d) -> Operation
+    {
+        auto f = files(d);
+        return [f]{Keep(f->first + f->second);};
+    }});
+    b.push_back({"BigIntFile/Multiply", MULTIPLY, [files](std::size_t d) -> Operation
+    {
+        auto f = files(d);
+        return [f]{Keep(f->first * f->second);};
+    }});
+    b.push_back({"BigIntFile/Print", LINEAR, [files](std::size_t d) -> Operation
+    {
+        auto f = files(d);
+        return [f]{std::ostringstream out; out << f->first; Keep(out.tellp());};
+    }});
+    // BigFrac
+    b.push_back(FracBinary("BigFrac/Add", VERY_SLOW, [](const BigFrac& x, const BigFrac& y){return x + y;}));
+    b.push_back(FracBinary("BigFrac/Subtract", VERY_SLOW, [](const BigFrac& x, const BigFrac& y){return x - y;}));
+    b.push_back(FracUnary("BigFrac/Minus", LINEAR, [](const BigFrac& x){return -x;}));
+    b.push_back(FracBinary("BigFrac/Multiply", VERY_SLOW, [](const BigFrac& x, const BigFrac& y){return x * y;}));
+    b.push_back(FracBinary("BigFrac/Divide", VERY_SLOW, [](const BigFrac& x, const BigFrac& y){return x / y;}));
+    b.push_back(FracUnary("BigFrac/Pow", SLOW, [](const BigFrac& x){return x ^ 4;}));
+    b.push_back(FracUnary("BigFrac/Abs", LINEAR, [](const BigFrac& x){return Abs(x);}));
+    b.push_back(Argument("BigFrac/Harmonic", VERY_SLOW, HarmonicArgument, [](int n){return Harmonic(n);}));
+    b.push_back(FracUnary("BigFrac/Approx", LINEAR, [](const BigFrac& x){return Approx(x);}));
+    b.push_back(FracUnary("BigFrac/ContinuedFraction", SLOW, [](const BigFrac& x){return ContinuedFraction(x);}));
+    b.push_back({"BigFrac/FromContinuedFraction", SLOW, [](std::size_t d) -> Operation
+    {
+        auto terms = ContinuedFraction(RandomFrac(d));
+        return [terms]{Keep(FromContinuedFraction(terms));};
+    }});
+    b.push_back({"BigFrac/LimitDenominator", SLOW, [](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d);
+        auto maxDen = RandomInt(d / 2);
+        return [x, maxDen]{Keep(LimitDenominator(x, maxDen));};
+    }});
+    b.push_back(FracBinary("BigFrac/Simplest", SLOW, [](const BigFrac& x, const BigFrac& y){return Simplest(x, y);}));
+    b.push_back(FracBinary("BigFrac/EqualQ", LINEAR, [](const BigFrac& x, const BigFrac& y){return x == y;}));
+    b.push_back(FracBinary("BigFrac/NotEqualQ", LINEAR, [](const BigFrac& x, const BigFrac& y){return x != y;}));
+    b.push_back(FracBinary("BigFrac/GreaterQ", QUADRATIC, [](const BigFrac& x, const BigFrac& y){return x > y;}));
+    b.push_back(FracBinary("BigFrac/LessQ", QUADRATIC, [](const BigFrac& x, const BigFrac& y){return x < y;}));
+    b.push_back(FracBinary("BigFrac/GreaterEqualQ", QUADRATIC, [](const BigFrac& x, const BigFrac& y){return x >= y;}));
+    b.push_back(FracBinary("BigFrac/LessEqualQ", QUADRATIC, [](const BigFrac& x, const BigFrac& y){return x <= y;}));
+    b.push_back({"BigFrac/Print", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d);
+        return [x]{std::ostringstream out; out << x; Keep(out);};
+    }});
+    b.push_back({"BigFrac/ToChars", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d);
+        auto buffer = std::make_shared<std::string>(FormattedSize(x), '\0');
+        return [x, buffer]{Keep(ToChars(&(*buffer)[0], &(*buffer)[0] + buffer->size(), x));};
+    }});
+    b.push_back(FracUnary("BigFrac/BinarySize", LINEAR, [](const BigFrac& x){return BinarySize(x);}));
+    b.push_back({"BigFrac/WriteBinary", LINEAR, [](std::size_t d) -> Operation
+    {
+        auto x = RandomFrac(d);
+        auto buffer = std::make_shared<std::string>(BinarySize(x), '\0');
+        return [x, buffer]{Keep(WriteBinary(&(*buffer)[0], x));};
+    }});
+    b.push_back({"BigFrac/ReadBigFrac", LINEAR, [](std::size_t d) -> Operation
+    {
+        std::ostringstream out;
+        WriteBinary(out, RandomFrac(d));
+        auto data = out.str();
+        return [data]{std::istringstream in(data); Keep(ReadBigFrac(in));};
+    }});
+    // Fixed-width integers
+    b.push_back(FixedBinary("FixedBigInt/Add", [](const Fixed& x, const Fixed& y){return x + y;}));
+    b.push_back(FixedBinary("FixedBigInt/Subtract", [](const Fixed& x, const Fixed& y){return x - y;}));
+    b.push_back(FixedBinary("FixedBigInt/Multiply", [](const Fixed& x, const Fixed& y){return x * y;}));
+    b.push_back({"FixedBigInt/Divide", FIXED, [](std::size_t d) -> Operation
+    {
+        auto x = Fixed(RandomInt(d)), y = Fixed(RandomInt(d / 2));
+        return [x, y]{Keep(x / y);};
+    }});
+    b.push_back({"FixedBigInt/Remainder", FIXED, [](std::size_t d) -> Operation
+    {
+        auto x = Fixed(RandomInt(d)), y = Fixed(RandomInt(d / 2));
+        return [x, y]{Keep(x % y);};
+    }});
+    b.push_back(FixedUnary("FixedBigInt/Pow", [](const Fixed& x){return x ^ 16;}));
+    b.push_back(FixedBinary("FixedBigInt/GCD", [](const Fixed& x, const Fixed& y){return GCD(x, y);}));
+    b.push_back(FixedUnary("FixedBigInt/ISqrt", [](const Fixed& x){return ISqrt(x);}));
+    b.push_back({"FixedBigInt/MulMod", FIXED, [](std::size_t d) -> Operation
+    {
+        auto x = Fixed(RandomInt(d)), y = Fixed(RandomInt(d)), m = Fixed(RandomInt(d));
+        return [x, y, m]{Keep(MulMod(x, y, m));};
+    }});
+    b.push_back(FixedBinary("FixedBigInt/BitXor", [](const Fixed& x, const Fixed& y){return BitXor(x, y);}));
+    b.push_back(FixedUnary("FixedBigInt/BitShiftLeft", [](const Fixed& x){return x << 64;}));
+    b.push_back(FixedBinary("FixedBigInt/LessQ", [](const Fixed& x, const Fixed& y){return x < y;}));
+    b.push_back(FixedUnary("FixedBigInt/IntegerLength", [](const Fixed& x){return IntegerLength(x);}));
+    b.push_back(FixedUnary("FixedBigInt/ToBigInt", [](const Fixed& x){return static_cast<BigInt>(x);}));
+    b.push_back(Unary("FixedBigInt/FromBigInt", FIXED, [](const BigInt& x){return Fixed(x);}));
+    // Asynchronous calls, including the start of a thread and the wait for the result
+    b.push_back(Argument("Async/Factorial", MULTIPLY, FactorialArgument, [](int n){return FactorialAsync(n).get();}));
+    b.push_back(Argument("Async/Fibonacci", SLOW, FibonacciArgument, [](int n){return FibonacciAsync(n).get();}));
+    b.push_back({"Async/Pow", MULTIPLY, [](std::size_t d) -> Operation
+    {
+        auto x = RandomInt(d / 16);
+        return [x]{Keep(PowAsync(x, 16).get());};
+    }});
+    b.push_back(Argument("Async/Harmonic", VERY_SLOW, HarmonicArgument, [](int n){return HarmonicAsync(n).get();}));
+    // Calls resuming from a preloaded checkpoint; these come last as they leave the cache enabled
+    auto cached = [](const std::string& name, const std::size_t limit, int (*argument)(std::size_t),
+                     const CacheFunction f, auto g) -> Benchmark
+    {
+        return {name, limit, [argument, f, g](std::size_t d) -> Operation
+        {
+            auto n = argument(d);
+            SetCacheLimit(CACHE_BYTES);
+            PreloadCache(f, n);
+            return [g, n]{Keep(g(n));};
+        }};
+    };
+    b.push_back(cached("Cached/Factorial", MULTIPLY, FactorialArgument, CacheFunction::Factorial,
+                       [](int n){return Factorial(n);}));
+    b.push_back(cached("Cached/Fibonacci", SLOW, FibonacciArgument, CacheFunction::Fibonacci,
+                       [](int n){return Fibonacci(n);}));
+    b.push_back(cached("Cached/Harmonic", VERY_SLOW, HarmonicArgument, CacheFunction::Harmonic,
+                       [](int n){return Harmonic(n);}));
+    return b;
+}
+
+static Result Measure(const Benchmark& b, const std::size_t digits, const double min_time)
+{
+    using Clock = std::chrono::steady_clock;
+    auto operation = b.setup(digits);
+    std::uint64_t iterations{1}, total{};
+    double elapsed{};
+    for (;;)
+    {
+        auto start = Clock::now();
+        for (std::uint64_t i{}; i < iterations; ++i)
+            operation();
+        elapsed += std::chrono::duration<double>(Clock::now() - start).count();
+        total += iterations;
+        if (elapsed >= min_time)
+            break;
+        iterations = total;
+    }
+    return {b.name, digits, total, elapsed * 1e9 / static_cast<double>(total)};
+}
+
+static void WriteJson(std::ostream& out, const std::vector<Result>& results, const double min_time, const std::size_t max_digits)
+{
+    out << "{\n";
+    out << "  \"context\": {\"threads\": " << ThreadCount() << ", \"min_time\": " << min_time
+        << ", \"max_digits\": " << max_digits << "},\n";
+    out << "  \"benchmarks\": [\n";
+    for (std::size_t i{}; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"digits\": " << r.digits << ", \"iterations\": "
+            << r.iterations << ", \"ns_per_op\": " << r.ns_per_op << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Reads the results written by WriteJson, one benchmark per line
+static std::vector<Result> ReadJson(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    auto field = [](const std::string& line, const std::string& key)
+    {
+        auto p = line.find("\"" + key + "\": ");
+        if (p == std::string::npos)
+        {
+            throw std::runtime_error("Missing " + key + " in: " + line);
+        }
+        p += key.length() + 4;
+        if (line[p] == '"')
+            return line.substr(p + 1, line.find('"', p + 1) - p - 1);
+        return line.substr(p, line.find_first_of(",}", p) - p);
+    };
+    std::vector<Result> results;
+    for (std::string line; std::getline(in, line);)
+        if (line.find("\"name\"") != std::string::npos)
+            results.push_back({field(line, "name"), std::stoull(field(line, "digits")),
+                               std::stoull(field(line, "iterations")), std::stod(field(line, "ns_per_op"))});
+    return results;
+}
+
+// Prints the change of every benchmark present in both runs; returns the number of regressions
+static int Compare(const std::string& baseline, const std::string& current, const double threshold)
+{
+    auto before = ReadJson(baseline), after = ReadJson(current);
+    int regressions{};
+    std::cout << "benchmark                        digits        before(ns)         after(ns)    change\n";
+    for (const auto& a : after)
+    {
+        for (const auto& b : before)
+        {
+            if (a.name != b.name || a.digits != b.digits)
+                continue;
+            auto change = (a.ns_per_op - b.ns_per_op) / b.ns_per_op;
+            auto regression = change > threshold;
+            regressions += regression ? 1 : 0;
+            char line[160];
+            std::snprintf(line, sizeof(line), "%-28s %10zu %17.1f %17.1f %+8.1f%%%s", a.name.c_str(), a.digits,
+                          b.ns_per_op, a.ns_per_op, change * 100, regression ? "  REGRESSION" : "");
+            std::cout << line << "\n";
+        }
+    }
+    std::cout << regressions << " regression(s) above " << threshold * 100 << "%\n";
+    return regressions;
+}
+
+static void Usage()
+{
+    std::cerr << "usage: bigint_bench [--filter TEXT] [--max-digits N] [--min-time SECONDS] [--threads N] [--out FILE]\n"
+                 "       bigint_bench --list\n"
+                 "       bigint_bench --compare BASELINE.json CURRENT.json [--threshold PERCENT]\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter, out_path, baseline, current;
+    std::size_t max_digits{100000};
+    double min_time{0.05}, threshold{10};
+    bool list{}, compare{};
+    try
+    {
+        for (int i{1}; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            if (arg == "--filter")
+                filter = value();
+            else if (arg == "--max-digits")
+                max_digits = std::stoull(value());
+            else if (arg == "--min-time")
+                min_time = std::stod(value());
+            else if (arg == "--threads")
+                SetThreadCount(static_cast<unsigned>(std::stoul(value())));
+            else if (arg == "--out")
+                out_path = value();
+            else if (arg == "--threshold")
+                threshold = std::stod(value());
+            else if (arg == "--list")
+                list = true;
+            else if (arg == "--compare")
+            {
+                compare = true;
+                baseline = value();
+                current = value();
+            }
+            else
+            {
+                Usage();
+                return 2;
+            }
+        }
+        if (compare)
+            return Compare(baseline, current, threshold / 100) == 0 ? 0 : 1;
+
+        std::vector<Result> results;
+        for (const auto& b : Benchmarks())
+        {
+            if (b.name.find(filter) == std::string::npos)
+                continue;
+            if (list)
+            {
+                std::cout << b.name << " (up to " << b.limit << " digits)\n";
+                continue;
+            }
+            for (auto digits : SIZES)
+            {
+                if (digits > std::min(b.limit, max_digits))
+                    break;
+                results.push_back(Measure(b, digits, min_time));
+                std::cerr << b.name << " " << digits << ": " << results.back().ns_per_op << " ns\n";
+            }
+        }
+        if (list)
+            return 0;
+        if (out_path.empty())
+            WriteJson(std::cout, results, min_time, max_digits);
+        else
+        {
+            std::ofstream out(out_path);
+            WriteJson(out, results, min_time, max_digits);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "bigint_bench: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+	bigint
+	
+	Copyright (c) 2025 Royal_X (MIT License)
+ 
+ 	https://github.com/RoyalXXX
+  	https://royalxxx.itch.io
+   	https://sourceforge.net/u/royal-x
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+	
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+// bigint_tune: measures the crossover points between the algorithms of bigint on this host
+// and writes them as a header. Building the library with -DBIGINT_TUNING_HEADER=<header>
+// makes them the defaults; SetTuning changes them at run time.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bigint.h"
+
+static constexpr std::size_t NEVER = std::numeric_limits<std::size_t>::max();
+
+static volatile unsigned char sink;
+
+static std::string RandomDigits(const std::size_t digits)
+{
+    static std::mt19937_64 generator{42};
+    std::uniform_int_distribution<int> digit(0, 9), lead(1, 9);
+    std::string s(digits, '0');
+    s[0] = static_cast<char>('0' + lead(generator));
+    for (std::size_t i{1}; i < digits; ++i)
+        s[i] = static_cast<char>('0' + digit(generator));
+    return s;
+}
+
+// Best time per call of f over three runs of at least min_time seconds, in nanoseconds
+static double Time(const std::function<void()>& f, const double min_time)
+{
+    using Clock = std::chrono::steady_clock;
+    double best{std::numeric_limits<double>::max()};
+    for (int run{}; run < 3; ++run)
+    {
+        std::uint64_t iterations{1}, total{};
+        double elapsed{};
+        for (;;)
+        {
+            auto start = Clock::now();
+            for (std::uint64_t i{}; i < iterations; ++i)
+                f();
+            elapsed += std::chrono::duration<double>(Clock::now() - start).count();
+            total += iterations;
+            if (elapsed >= min_time)
+                break;
+            iterations = total;
+        }
+        best = std::min(best, elapsed * 1e9 / static_cast<double>(total));
+    }
+    return best;
+}
+
+// Times f at every size with the threshold set to NEVER and to the size itself, and returns
+// the first size from which the second setting stays faster, or NEVER
+static std::size_t Crossover(const std::vector<std::size_t>& sizes, std::size_t BigIntTuning::*threshold,
+                             const std::function<std::function<void()>(std::size_t)>& setup,
+                             const double min_time, const char* unit)
+{
+    auto base = Tuning();
+    std::vector<bool> wins;
+    for (auto n : sizes)
+    {
+        auto f = setup(n);
+        auto t = base;
+        t.*threshold = NEVER;
+        SetTuning(t);
+        auto before = Time(f, min_time);
+        t.*threshold = n;
+        SetTuning(t);
+        auto after = Time(f, min_time);
+        wins.push_back(after < before);
+        std::cerr << "  " << n << " " << unit << ": " << before << " ns / " << after << " ns\n";
+    }
+    SetTuning(base);
+    auto i = wins.size();
+    while (i > 0 && wins[i - 1])
+        --i;
+    return i < sizes.size() ? sizes[i] : NEVER;
+}
+
+static std::function<void()> Product(const std::size_t x_digits, const std::size_t y_digits)
+{
+    BigInt x(RandomDigits(x_digits)), y(RandomDigits(y_digits));
+    return [x, y]{sink = sink ^ static_cast<unsigned char>((x * y).get_value().back());};
+}
+
+// Digit by digit products against base 10^9 limbs, for square and lopsided factors
+static std::size_t TuneLimbs(const double min_time)
+{
+    std::vector<std::size_t> sizes;
+    for (std::size_t n{1}; n <= 40; ++n)
+        sizes.push_back(n);
+    auto n = Crossover(sizes, &BigIntTuning::limb_threshold, [](std::size_t n)
+    {
+        auto square = Product(n, n), lopsided = Product(n, 20 * n);
+        return [square, lopsided]{square(); lopsided();};
+    }, min_time, "digits");
+    return n == NEVER ? sizes.back() + 1 : n;
+}
+
+// Every candidate threshold over products from 16 to 512 limbs; the best has the smallest
+// sum of times relative to the fastest candidate at each size
+static std::size_t TuneKaratsuba(const double min_time)
+{
+    const std::vector<std::size_t> candidates{8, 12, 16, 20, 24, 28, 32, 40, 48, 56, 64, 80, 96, 128};
+    const std::vector<std::size_t> sizes{16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+    auto base = Tuning();
+    std::vector<std::vector<double>> times(candidates.size(), std::vector<double>(sizes.size()));
+    for (std::size_t j{}; j < sizes.size(); ++j)
+    {
+        auto f = Product(9 * sizes[j], 9 * sizes[j]);
+        for (std::size_t i{}; i < candidates.size(); ++i)
+        {
+            auto t = base;
+            t.karatsuba_threshold = candidates[i];
+            SetTuning(t);
+            times[i][j] = Time(f, min_time);
+        }
+    }
+    SetTuning(base);
+    std::size_t best{};
+    double best_cost{std::numeric_limits<double>::max()};
+    for (std::size_t i{}; i < candidates.size(); ++i)
+    {
+        double cost{};
+        for (std::size_t j{}; j < sizes.size(); ++j)
+        {
+            double fastest{std::numeric_limits<double>::max()};
+            for (const auto& row : times)
+                fastest = std::min(fastest, row[j]);
+            cost += times[i][j] / fastest;
+        }
+        std::cerr << "  " << candidates[i] << " limbs: " << cost / static_cast<double>(sizes.size()) << "\n";
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = candidates[i];
+        }
+    }
+    return best;
+}
+
+// Shifts by 32 bits at a time against a product by a power of two
+static std::size_t TuneShift(const double min_time)
+{
+    const std::vector<std::size_t> sizes{256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536};
+    auto n = Crossover(sizes, &BigIntTuning::shift_multiply_threshold, [](std::size_t n)
+    {
+        // Shifts longer than the threshold multiply
+        BigInt x(RandomDigits(1000));
+        auto y = static_cast<int>(n) + 1;
+        return [x, y]{sink = sink ^ static_cast<unsigned char>((x << y).get_value().back());};
+    }, min_time, "bits");
+    return n == NEVER ? sizes.back() : n;
+}
+
+// Serial products against products whose top Karatsuba split runs on the thread pool
+static std::size_t TuneParallel(const double min_time)
+{
+    const std::vector<std::size_t> sizes{2000, 5000, 10000, 20000, 50000, 100000, 200000};
+    return Crossover(sizes, &BigIntTuning::parallel_threshold, [](std::size_t n){return Product(n, n);},
+                     min_time, "digits");
+}
+
+// Values carry a u suffix: a threshold that never pays off is the largest std::size_t,
+// which does not fit a signed literal
+static void WriteHeader(std::ostream& out, const BigIntTuning& t)
+{
+    out << "// Generated by bigint_tune: crossover points measured on this host with "
+        << ThreadCount() << " threads.\n"
+           "// Build bigint with -DBIGINT_TUNING_HEADER=<path of this file> to use them.\n"
+           "#pragma once\n\n"
+        << "#define BIGINT_LIMB_THRESHOLD " << t.limb_threshold << "u\n"
+        << "#define BIGINT_KARATSUBA_THRESHOLD " << t.karatsuba_threshold << "u\n"
+        << "#define BIGINT_SHIFT_MULTIPLY_THRESHOLD " << t.shift_multiply_threshold << "u\n"
+        << "#define BIGINT_PARALLEL_THRESHOLD " << t.parallel_threshold << "u\n";
+}
+
+static void Usage()
+{
+    std::cerr << "usage: bigint_tune [--min-time SECONDS] [--threads N] [--out FILE]\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string out_path;
+    double min_time{0.01};
+    try
+    {
+        for (int i{1}; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            if (arg == "--min-time")
+                min_time = std::stod(value());
+            else if (arg == "--threads")
+                SetThreadCount(static_cast<unsigned>(std::stoul(value())));
+            else if (arg == "--out")
+                out_path = value();
+            else
+            {
+                Usage();
+                return 2;
+            }
+        }
+
+        // Opened first, so that a bad path fails before the measurements
+        std::ofstream out;
+        if (!out_path.empty())
+        {
+            out.open(out_path);
+            if (!out)
+            {
+                throw std::runtime_error("Cannot open " + out_path);
+            }
+        }
+        auto t = Tuning();
+        std::cerr << "limb threshold\n";
+        t.limb_threshold = TuneLimbs(min_time);
+        SetTuning(t);
+        std::cerr << "Karatsuba threshold\n";
+        t.karatsuba_threshold = TuneKaratsuba(min_time);
+        SetTuning(t);
+        std::cerr << "shift multiply threshold\n";
+        t.shift_multiply_threshold = TuneShift(min_time);
+        SetTuning(t);
+        // A single thread never runs products in parallel, so its threshold is kept
+        if (ThreadCount() > 1)
+        {
+            std::cerr << "parallel threshold\n";
+            t.parallel_threshold = TuneParallel(min_time);
+        }
+        if (out_path.empty())
+            WriteHeader(std::cout, t);
+        else
+        {
+            WriteHeader(out, t);
+            out.close();
+            if (!out)
+            {
+                throw std::runtime_error("Cannot write " + out_path);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "bigint_tune: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
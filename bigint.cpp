@@ -31,9 +31,26 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdlib>
+#include <cstdint>
 #include <utility>
-#include <sstream>
+#include <cstdio>
+#include <cmath>
 #include <stdexcept>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include <limits>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <memory>
+#include <fstream>
+#include <filesystem>
 
 #include "bigint.h"
 
@@ -43,614 +60,4285 @@ inline const BigInt TWO{"2"};
 inline const BigFrac F_ZERO;
 inline const BigFrac F_ONE{"1", "1"};
 
-static inline int IntegerQ(const std::string& s)
+// Instrumentation is compiled in only with BIGINT_STATS; otherwise the recording macros
+// expand to nothing. Every thread counts into its own block with relaxed atomics, and
+// the blocks are registered so that Stats can sum them and ResetStats can clear them.
+#ifdef BIGINT_STATS
+static constexpr std::size_t STATS_OPERATIONS = static_cast<std::size_t>(StatsOperation::Count);
+static constexpr std::size_t STATS_TIERS = static_cast<std::size_t>(MultiplyTier::Count);
+
+struct StatsBlock
 {
-    if (s.empty())
-        return 0;
-    if (s.length() > 1)
+    std::atomic<std::uint64_t> calls[STATS_OPERATIONS] = {};
+    std::atomic<std::uint64_t> nanoseconds[STATS_OPERATIONS] = {};
+    std::atomic<std::uint64_t> sizes[STATS_OPERATIONS][STATS_SIZE_BUCKETS] = {};
+    std::atomic<std::uint64_t> tiers[STATS_TIERS] = {};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocated_bytes{0};
+};
+
+static void Collect(BigIntStats& z, StatsBlock& block, const bool reset)
+{
+    auto take = [reset](std::atomic<std::uint64_t>& c)
     {
-        if (s[0] == '0')
-            return 0;
-        else if (s[0] == '-')
-        {
-            if (s[1] == '0')
-                return 0;
-            if (!std::all_of(s.cbegin() + 1, s.cend(), isdigit))
-                    return 0;
-            return -1; // Negative integer
-        }
+        return reset ? c.exchange(0, std::memory_order_relaxed) : c.load(std::memory_order_relaxed);
+    };
+    for (std::size_t i = 0; i < STATS_OPERATIONS; ++i)
+    {
+        z.operations[i].calls += take(block.calls[i]);
+        z.operations[i].nanoseconds += take(block.nanoseconds[i]);
+        for (std::size_t k = 0; k < STATS_SIZE_BUCKETS; ++k)
+            z.operations[i].sizes[k] += take(block.sizes[i][k]);
     }
-    if (!std::all_of(s.cbegin(), s.cend(), isdigit))
-            return 0;
-    return 1; // Non-negative integer
+    for (std::size_t i = 0; i < STATS_TIERS; ++i)
+        z.multiply_tiers[i] += take(block.tiers[i]);
+    z.allocations += take(block.allocations);
+    z.allocated_bytes += take(block.allocated_bytes);
 }
 
-BigInt::BigInt(const char* s) : BigInt(std::string(s)) {}
-BigInt::BigInt(const std::string& s)
-    : value(s)
+class StatsRegistry
 {
-    auto s_q = IntegerQ(value);
-    if (s_q == 0)
+public:
+    static StatsRegistry& Instance()
     {
-        throw std::invalid_argument("ERROR: Not a number");
+        static StatsRegistry registry;
+        return registry;
     }
-    if (s_q == -1)
+    void Add(StatsBlock* block)
     {
-        value.erase(0, 1);
-        sign = true;
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.push_back(block);
     }
-}
-BigInt::BigInt(std::string&& s)
-    : value(std::move(s))
-{
-    auto s_q = IntegerQ(value);
-    if (s_q == 0)
+    // The counts of a finished thread are kept
+    void Remove(StatsBlock* block)
     {
-        throw std::invalid_argument("ERROR: Not a number");
+        std::lock_guard<std::mutex> lock(mutex);
+        Collect(retired, *block, true);
+        blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+    }
+    BigIntStats Snapshot(const bool reset)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto z = retired;
+        if (reset)
+            retired = BigIntStats();
+        for (auto block : blocks)
+            Collect(z, *block, reset);
+        return z;
     }
-    if (s_q == -1)
+private:
+    std::mutex mutex;
+    std::vector<StatsBlock*> blocks;
+    BigIntStats retired;
+};
+
+class ThreadStats
+{
+public:
+    ThreadStats() {StatsRegistry::Instance().Add(&block);}
+    ~ThreadStats() {StatsRegistry::Instance().Remove(&block);}
+    StatsBlock block;
+};
+
+static StatsBlock& LocalStats()
+{
+    thread_local ThreadStats stats;
+    return stats.block;
+}
+
+static inline std::size_t SizeBucket(std::size_t digits)
+{
+    std::size_t k = 0;
+    while (digits >= 10 && k + 1 < STATS_SIZE_BUCKETS)
     {
-        value.erase(0, 1);
-        sign = true;
+        digits /= 10;
+        ++k;
     }
+    return k;
 }
 
-BigInt& BigInt::operator=(const char* s)
+// Counts a call and its operand size on construction and its time on destruction;
+// nested operations are timed inclusively
+class StatsScope
 {
-    value = std::string(s);
-    auto s_q = IntegerQ(value);
-    if (s_q == 0)
+public:
+    StatsScope(const StatsOperation op, const std::size_t digits)
+        : index(static_cast<std::size_t>(op)), start(std::chrono::steady_clock::now())
     {
-        throw std::invalid_argument("ERROR: Not a number");
+        auto& block = LocalStats();
+        block.calls[index].fetch_add(1, std::memory_order_relaxed);
+        block.sizes[index][SizeBucket(digits)].fetch_add(1, std::memory_order_relaxed);
     }
-    if (s_q == -1)
+    ~StatsScope()
     {
-        value.erase(0, 1);
-        sign = true;
+        auto t = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        LocalStats().nanoseconds[index].fetch_add(static_cast<std::uint64_t>(t.count()), std::memory_order_relaxed);
     }
-    else
-        sign = false;
-    return *this;
-}
-BigInt& BigInt::operator+=(const BigInt& x)
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+private:
+    std::size_t index;
+    std::chrono::steady_clock::time_point start;
+};
+
+static inline void CountTier(const MultiplyTier tier)
 {
-    *this = *this + x;
-    return *this;
+    LocalStats().tiers[static_cast<std::size_t>(tier)].fetch_add(1, std::memory_order_relaxed);
 }
-BigInt& BigInt::operator-=(const BigInt& x)
+static inline void CountAllocation(const std::size_t bytes)
 {
-    *this = *this - x;
-    return *this;
+    auto& block = LocalStats();
+    block.allocations.fetch_add(1, std::memory_order_relaxed);
+    block.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
 }
-BigInt& BigInt::operator*=(const BigInt& x)
+
+#define BIGINT_STATS_SCOPE(op, digits) StatsScope stats_scope(StatsOperation::op, digits)
+#define BIGINT_STATS_TIER(tier) CountTier(MultiplyTier::tier)
+#define BIGINT_STATS_ALLOCATION(bytes) CountAllocation(bytes)
+// Counts the allocation a container makes when it has to grow to n elements
+#define BIGINT_STATS_GROW(c, n) \
+    ((c).capacity() < (n) ? CountAllocation((n) * sizeof((c)[0])) : static_cast<void>(0))
+#else
+#define BIGINT_STATS_SCOPE(op, digits) static_cast<void>(0)
+#define BIGINT_STATS_TIER(tier) static_cast<void>(0)
+#define BIGINT_STATS_ALLOCATION(bytes) static_cast<void>(0)
+#define BIGINT_STATS_GROW(c, n) static_cast<void>(0)
+#endif
+
+// Memoization cache. Checkpoints live in an immutable snapshot that readers search without
+// locking: a reader announces itself in the counter of the current epoch, and a writer that
+// replaced the snapshot flips the epoch and waits for the old counter to drain before it
+// frees the old snapshot. Snapshots share their checkpoints; the oldest checkpoint goes
+// first when the limit is exceeded.
+static constexpr std::size_t CACHE_FUNCTIONS = static_cast<std::size_t>(CacheFunction::Count);
+
+struct Checkpoint
 {
-    *this = *this * x;
-    return *this;
+    int n{};
+    std::uint64_t order{};
+    std::size_t bytes{};
+    // n!, F(n) and F(n + 1), or the numerator and denominator of H(n)
+    std::vector<BigInt> values;
+};
+struct CacheSnapshot
+{
+    // Sorted by n
+    std::vector<std::shared_ptr<const Checkpoint>> tables[CACHE_FUNCTIONS];
+    std::size_t bytes{};
+};
+
+class MemoCache
+{
+public:
+    static MemoCache& Instance()
+    {
+        static MemoCache cache;
+        return cache;
+    }
+    ~MemoCache() {delete snapshot.load();}
+
+    std::size_t Limit() const {return limit.load(std::memory_order_relaxed);}
+    bool Enabled() const {return Limit() != 0;}
+    // The checkpoint with the largest n not above the argument, if any
+    std::shared_ptr<const Checkpoint> Find(const CacheFunction f, const int n)
+    {
+        std::shared_ptr<const Checkpoint> c;
+        {
+            ReadSection read(*this);
+            const auto& table = snapshot.load()->tables[static_cast<std::size_t>(f)];
+            auto i = std::upper_bound(table.begin(), table.end(), n,
+                                      [](const int k, const auto& e){return k < e->n;});
+            if (i != table.begin())
+                c = *std::prev(i);
+        }
+        (c ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+        return c;
+    }
+    void Insert(const CacheFunction f, const int n, std::vector<BigInt> values)
+    {
+        auto c = std::make_shared<Checkpoint>();
+        c->n = n;
+        c->bytes = sizeof(Checkpoint);
+        for (const auto& v : values)
+            c->bytes += sizeof(BigInt) + v.get_value().length();
+        c->values = std::move(values);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto max = Limit();
+        if (c->bytes > max)
+            return;
+        auto next = std::make_unique<CacheSnapshot>(*snapshot.load());
+        auto& table = next->tables[static_cast<std::size_t>(f)];
+        auto i = std::lower_bound(table.begin(), table.end(), n,
+                                  [](const auto& e, const int k){return e->n < k;});
+        if (i != table.end() && (*i)->n == n)
+            return;
+        c->order = order++;
+        next->bytes += c->bytes;
+        table.insert(i, std::move(c));
+        Shrink(*next, max);
+        Publish(std::move(next));
+    }
+    void SetLimit(const std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = bytes;
+        auto next = std::make_unique<CacheSnapshot>(*snapshot.load());
+        Shrink(*next, bytes);
+        Publish(std::move(next));
+    }
+    void Evict(const std::size_t first, const std::size_t last)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto next = std::make_unique<CacheSnapshot>(*snapshot.load());
+        for (auto f = first; f < last; ++f)
+        {
+            for (const auto& c : next->tables[f])
+                next->bytes -= c->bytes;
+            next->tables[f].clear();
+        }
+        Publish(std::move(next));
+    }
+    CacheInfo Info()
+    {
+        CacheInfo info;
+        {
+            ReadSection read(*this);
+            auto s = snapshot.load();
+            for (std::size_t f{}; f < CACHE_FUNCTIONS; ++f)
+            {
+                info.checkpoints[f] = s->tables[f].size();
+                info.largest[f] = s->tables[f].empty() ? 0 : s->tables[f].back()->n;
+            }
+            info.bytes = s->bytes;
+        }
+        info.limit = Limit();
+        info.hits = hits.load(std::memory_order_relaxed);
+        info.misses = misses.load(std::memory_order_relaxed);
+        return info;
+    }
+private:
+    class ReadSection
+    {
+    public:
+        explicit ReadSection(MemoCache& cache) : readers(nullptr)
+        {
+            for (;;)
+            {
+                auto e = cache.epoch.load();
+                readers = &cache.readers[e & 1];
+                readers->fetch_add(1);
+                if (cache.epoch.load() == e)
+                    break;
+                readers->fetch_sub(1);
+            }
+        }
+        ~ReadSection() {readers->fetch_sub(1);}
+        ReadSection(const ReadSection&)=delete;
+        ReadSection& operator=(const ReadSection&)=delete;
+    private:
+        std::atomic<std::size_t>* readers;
+    };
+
+    MemoCache() : snapshot(new CacheSnapshot) {}
+
+    static void Shrink(CacheSnapshot& s, const std::size_t max)
+    {
+        while (s.bytes > max)
+        {
+            std::vector<std::shared_ptr<const Checkpoint>>* oldest{};
+            std::vector<std::shared_ptr<const Checkpoint>>::iterator i;
+            for (auto& table : s.tables)
+                for (auto j = table.begin(); j != table.end(); ++j)
+                    if (!oldest || (*j)->order < (*i)->order)
+                    {
+                        oldest = &table;
+                        i = j;
+                    }
+            s.bytes -= (*i)->bytes;
+            oldest->erase(i);
+        }
+    }
+    // Called with the mutex held
+    void Publish(std::unique_ptr<CacheSnapshot> next)
+    {
+        auto old = snapshot.exchange(next.release());
+        // Only readers registered under the epoch before the flip can still see old
+        auto e = epoch.fetch_add(1);
+        while (readers[e & 1].load() != 0)
+            std::this_thread::yield();
+        delete old;
+    }
+
+    std::atomic<CacheSnapshot*> snapshot;
+    std::atomic<unsigned> epoch{};
+    std::atomic<std::size_t> readers[2]{};
+    std::atomic<std::size_t> limit{};
+    std::atomic<std::uint64_t> hits{}, misses{};
+    std::uint64_t order{};
+    std::mutex mutex;
+};
+
+static inline bool SpaceQ(const char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
 }
-BigInt& BigInt::operator/=(const BigInt& x)
+// Value of the digit c, or 36 when c is not a digit in any base
+static inline int DigitValue(const char c)
 {
-    *this = *this / x;
-    return *this;
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return 36;
 }
-BigInt& BigInt::operator%=(const BigInt& x)
+
+// An integer in [first, last): optional whitespace and sign, then digits of the base
+struct IntegerSpan
 {
-    *this = *this % x;
-    return *this;
+    const char* begin; // first significant digit, leading zeros are skipped
+    const char* end;   // end of the digits
+    bool sign;
+    bool valid;        // at least one digit was found
+};
+static IntegerSpan ScanInteger(const char* first, const char* last, const int base)
+{
+    IntegerSpan span{first, first, false, false};
+    auto p = first;
+    while (p != last && SpaceQ(*p))
+        ++p;
+    if (p != last && (*p == '-' || *p == '+'))
+        span.sign = *p++ == '-';
+    auto digits = p;
+    while (p != last && *p == '0')
+        ++p;
+    span.begin = p;
+    while (p != last && DigitValue(*p) < base)
+        ++p;
+    span.end = p;
+    span.valid = p != digits;
+    return span;
 }
-BigInt& BigInt::operator^=(const int p)
+
+// Scratch buffers are borrowed from a per-thread pool and handed back on scope exit
+// with their capacity intact, so the temporaries of an operation reuse the memory of
+// the previous one instead of going through the global heap.
+class Scratch
 {
-    *this = *this ^ p;
-    return *this;
+public:
+    Scratch()
+    {
+        auto& pool = Pool();
+        if (!pool.empty())
+        {
+            buffer = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+    ~Scratch()
+    {
+        auto& pool = Pool();
+        if (pool.size() < MAX_POOLED && buffer.capacity() <= MAX_POOLED_CAPACITY)
+        {
+            buffer.clear();
+            pool.push_back(std::move(buffer));
+        }
+    }
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    std::string& operator*() {return buffer;}
+    std::string* operator->() {return &buffer;}
+private:
+    static constexpr std::size_t MAX_POOLED = 16;
+    static constexpr std::size_t MAX_POOLED_CAPACITY = std::size_t{1} << 26;
+
+    static std::vector<std::string>& Pool()
+    {
+        thread_local std::vector<std::string> pool;
+        return pool;
+    }
+
+    std::string buffer;
+};
+
+static inline int CompareMagnitude(const std::string& a, const std::string& b)
+{
+    if (a.length() != b.length())
+        return a.length() < b.length() ? -1 : 1;
+    return a.compare(b);
 }
 
-const std::string& BigInt::get_value() const {return value;}
-bool BigInt::get_sign() const {return sign;}
+// Digit strings are added and subtracted eight digits at a time in a 64-bit word, one
+// digit per byte with the last digit in the lowest byte. Biasing every byte by 246
+// makes the carry (or borrow) of a decimal digit coincide with the binary carry out of
+// its byte, so the word adder propagates decimal carries across all eight digits.
+static constexpr std::uint64_t BYTES = 0x0101010101010101;
+static constexpr std::uint64_t BIAS = 0xF6 * BYTES;
 
-std::ostream& operator<<(std::ostream& out, const BigInt& x)
+static inline std::uint64_t LoadDigits(const char* end)
 {
-    if (x.sign)
-        return out << '-' << x.value;
-    return out << x.value;
+    auto p = reinterpret_cast<const unsigned char*>(end - 8);
+    auto w = std::uint64_t{p[0]} << 56 | std::uint64_t{p[1]} << 48 | std::uint64_t{p[2]} << 40
+        | std::uint64_t{p[3]} << 32 | std::uint64_t{p[4]} << 24 | std::uint64_t{p[5]} << 16
+        | std::uint64_t{p[6]} << 8 | std::uint64_t{p[7]};
+    return w - '0' * BYTES;
+}
+static inline void StoreDigits(char* end, std::uint64_t w)
+{
+    w += '0' * BYTES;
+    auto p = reinterpret_cast<unsigned char*>(end - 8);
+    p[0] = static_cast<unsigned char>(w >> 56);
+    p[1] = static_cast<unsigned char>(w >> 48);
+    p[2] = static_cast<unsigned char>(w >> 40);
+    p[3] = static_cast<unsigned char>(w >> 32);
+    p[4] = static_cast<unsigned char>(w >> 24);
+    p[5] = static_cast<unsigned char>(w >> 16);
+    p[6] = static_cast<unsigned char>(w >> 8);
+    p[7] = static_cast<unsigned char>(w);
 }
 
-BigInt operator+(const BigInt& x, const BigInt& y)
+// r = a + b + c over the n digits ending at r, a and b (r may alias a); returns the carry
+static unsigned AddDigits(char* r, const char* a, const char* b, std::size_t n, unsigned c)
+{
+    for (; n >= 8; n -= 8, r -= 8, a -= 8, b -= 8)
+    {
+        auto s = LoadDigits(a) + BIAS;
+        auto w = s + LoadDigits(b) + c;
+        c = w >> 63 == 0 ? 1 : 0;
+        StoreDigits(r, w - (w >> 7 & BYTES) * 0xF6);
+    }
+    for (; n > 0; --n)
+    {
+        unsigned d = *--a - '0' + *--b - '0' + c;
+        c = d >= 10 ? 1 : 0;
+        *--r = d - 10 * c + '0';
+    }
+    return c;
+}
+// r = a - b - c over the n digits ending at r, a and b (r may alias a); returns the borrow
+static unsigned SubtractDigits(char* r, const char* a, const char* b, std::size_t n, unsigned c)
 {
+    for (; n >= 8; n -= 8, r -= 8, a -= 8, b -= 8)
+    {
+        auto w = LoadDigits(a) - LoadDigits(b) - c;
+        c = w >> 63 != 0 ? 1 : 0;
+        StoreDigits(r, w - (w >> 7 & BYTES) * 0xF6);
+    }
+    for (; n > 0; --n)
+    {
+        int d = *--a - *--b - static_cast<int>(c);
+        c = d < 0 ? 1 : 0;
+        *--r = d + 10 * static_cast<int>(c) + '0';
+    }
+    return c;
+}
 
-    if (!x.sign && y.sign)
-        return x - Abs(y);
-    if (x.sign && !y.sign)
-        return y - Abs(x);
-    std::string a, b;
-    a.assign(x.value.crbegin(), x.value.crend());
-    b.assign(y.value.crbegin(), y.value.crend());
-    if (b.length() > a.length())
-        std::swap(a, b);
-    int c{}, d;
-    for (std::size_t i{}; i < a.length(); ++i)
+// a -= b, both big-endian digit strings and a >= b
+static inline void SubtractMagnitude(std::string& a, const std::string& b)
+{
+    auto i = a.length() - b.length();
+    auto c = SubtractDigits(&a[0] + a.length(), a.data() + a.length(), b.data() + b.length(), b.length(), 0);
+    while (c != 0)
     {
-        if (c == 0 && i >= b.length())
-            break;
-        if (i < b.length())
-            d = a[i] - '0' + b[i] - '0' + c;
-        else
-            d = a[i] - '0' + c;
-        a[i] = d % 10 + '0';
-        c = d / 10;
+        --i;
+        c = a[i] == '0' ? 1 : 0;
+        a[i] = c != 0 ? '9' : a[i] - 1;
     }
-    if (c != 0)
-        a.push_back('1');
-    std::reverse(a.begin(), a.end());
-    BigInt z;
-    z.value = a;
-    if (x.sign && y.sign)
-        z.sign = true;
-    return z;
+    auto p = a.find_first_not_of('0');
+    a.erase(0, p == std::string::npos ? a.length() - 1 : p);
 }
-BigInt operator-(const BigInt& x, const BigInt& y)
+
+// a += b, both big-endian digit strings
+static inline void AddMagnitude(std::string& a, const std::string& b)
 {
-    if (!x.sign && y.sign)
-        return x + Abs(y);
-    if (x.sign && !y.sign)
+    if (a.length() < b.length())
     {
-        BigInt z = Abs(x) + y;
-        z.sign = true;
-        return z;
+        BIGINT_STATS_GROW(a, b.length());
+        a.insert(0, b.length() - a.length(), '0');
     }
-    if (x.sign && y.sign)
-        return Abs(y) - Abs(x);
-    if (x < y)
+    auto i = a.length() - b.length();
+    auto c = AddDigits(&a[0] + a.length(), a.data() + a.length(), b.data() + b.length(), b.length(), 0);
+    for (; c != 0 && i > 0; --i)
     {
-        BigInt z = y - x;
-        z.sign = true;
-        return z;
+        c = a[i - 1] == '9' ? 1 : 0;
+        a[i - 1] = c != 0 ? '0' : a[i - 1] + 1;
     }
-    std::string a(x.value.crbegin(), x.value.crend());
-    std::string b(y.value.crbegin(), y.value.crend());
-    int c{}, d;
-    for (std::size_t i{}; i < a.length(); ++i)
+    if (c != 0)
     {
-        if (c == 0 && i >= b.length())
-            break;
-        if (i < b.length())
-            d = a[i] - b[i] - c;
-        else
-            d = a[i] - '0' - c;
-        if (d < 0)
+        BIGINT_STATS_GROW(a, a.length() + 1);
+        a.insert(0, 1, '1');
+    }
+}
+
+// acc += x * y, where acc is a little-endian digit string and x, y are big-endian
+static void MulAddMagnitude(std::string& acc, const std::string& x, const std::string& y)
+{
+    const auto n = x.length(), m = y.length();
+    if (acc.length() < n + m)
+        acc.resize(n + m, '0');
+    for (std::size_t i{}; i < m; ++i)
+    {
+        int b = y[m - 1 - i] - '0';
+        if (b == 0)
+            continue;
+        int c{};
+        auto k = i;
+        for (std::size_t j{}; j < n; ++j, ++k)
         {
-            a[i] = 10 + d + '0';
-            c = 1;
+            int d = acc[k] - '0' + b * (x[n - 1 - j] - '0') + c;
+            acc[k] = d % 10 + '0';
+            c = d / 10;
         }
-        else
+        for (; c != 0; ++k)
         {
-            a[i] = d + '0';
-            c = 0;
+            if (k == acc.length())
+                acc.push_back('0');
+            int d = acc[k] - '0' + c;
+            acc[k] = d % 10 + '0';
+            c = d / 10;
         }
     }
-    while (a.back() == '0' && a.length() > 1)
-        a.pop_back();
-    std::reverse(a.begin(), a.end());
-    BigInt z;
-    z.value = a;
-    return z;
+    while (acc.length() > 1 && acc.back() == '0')
+        acc.pop_back();
 }
-BigInt operator-(const BigInt& x)
+
+// q = x / y and r = x mod y for big-endian digit strings, y != 0; q may be null
+static void DivideMagnitude(std::string* q, std::string& r, const std::string& x, const std::string& y)
 {
-    BigInt y{x};
-    y.sign = !y.sign;
-    return y;
+    r.clear();
+    if (q)
+        q->clear();
+    for (const auto& d : x)
+    {
+        if (r == "0")
+            r.clear();
+        r.push_back(d);
+        char digit = '0';
+        while (CompareMagnitude(r, y) >= 0)
+        {
+            SubtractMagnitude(r, y);
+            ++digit;
+        }
+        if (q && (digit != '0' || !q->empty()))
+            q->push_back(digit);
+    }
+    if (r.empty())
+        r = "0";
+    if (q && q->empty())
+        *q = "0";
 }
-BigInt operator*(const BigInt& x, const BigInt& y)
+static inline void RemainderMagnitude(std::string& r, const std::string& x, const std::string& y)
 {
-    if (x.sign && y.sign)
-        return Abs(x) * Abs(y);
-    if (x.value == "0" || y.value == "0")
-        return ZERO;
-    if (x.sign)
+    DivideMagnitude(nullptr, r, x, y);
+}
+
+// Large products are computed on little-endian base 10^9 limbs
+using Limb = std::uint32_t;
+static constexpr Limb LIMB_BASE = 1000000000;
+static constexpr std::size_t LIMB_DIGITS = 9;
+
+// Crossover points between algorithms. The defaults can be replaced by the header that
+// bigint_tune writes, named by BIGINT_TUNING_HEADER, and at run time by SetTuning.
+#ifdef BIGINT_TUNING_HEADER
+#include BIGINT_TUNING_HEADER
+#endif
+#ifndef BIGINT_LIMB_THRESHOLD
+#define BIGINT_LIMB_THRESHOLD 8
+#endif
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 40
+#endif
+#ifndef BIGINT_SHIFT_MULTIPLY_THRESHOLD
+#define BIGINT_SHIFT_MULTIPLY_THRESHOLD 4096
+#endif
+#ifndef BIGINT_PARALLEL_THRESHOLD
+#define BIGINT_PARALLEL_THRESHOLD 20000
+#endif
+// Karatsuba splits of fewer limbs do not get smaller
+static constexpr std::size_t MIN_KARATSUBA_THRESHOLD = 4;
+
+static std::atomic<std::size_t> limb_threshold{BIGINT_LIMB_THRESHOLD}; // digits
+static std::atomic<std::size_t> karatsuba_threshold{
+    std::max<std::size_t>(BIGINT_KARATSUBA_THRESHOLD, MIN_KARATSUBA_THRESHOLD)}; // limbs
+static std::atomic<std::size_t> shift_multiply_threshold{BIGINT_SHIFT_MULTIPLY_THRESHOLD}; // bits
+static std::atomic<std::size_t> parallel_threshold{BIGINT_PARALLEL_THRESHOLD}; // digits
+
+static void ToLimbs(std::vector<Limb>& l, const std::string& s)
+{
+    BIGINT_STATS_GROW(l, (s.length() + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    l.assign((s.length() + LIMB_DIGITS - 1) / LIMB_DIGITS, 0);
+    auto end = s.length();
+    for (auto& limb : l)
     {
-        BigInt z = Abs(x) * y;
-        z.sign = true;
-        return z;
+        auto begin = end > LIMB_DIGITS ? end - LIMB_DIGITS : 0;
+        Limb v{};
+        for (auto i = begin; i < end; ++i)
+            v = v * 10 + (s[i] - '0');
+        limb = v;
+        end = begin;
     }
-    if (y.sign)
+}
+static void FromLimbs(std::string& s, const Limb* l, std::size_t n)
+{
+    while (n > 1 && l[n - 1] == 0)
+        --n;
+    if (n == 0)
     {
-        BigInt z = x * Abs(y);
-        z.sign = true;
-        return z;
+        s = "0";
+        return;
     }
-    if (x.value == "1")
-        return y;
-    if (y.value == "1")
-        return x;
-    BigInt z;
-    std::string a(x.value.crbegin(), x.value.crend()), b(y.value.crbegin(), y.value.crend()), temp;
-    temp.reserve(a.size() + 1);
-    for (std::size_t i{}; i < b.size(); ++i)
+    s = std::to_string(l[n - 1]);
+    auto top = s.length();
+    BIGINT_STATS_GROW(s, top + (n - 1) * LIMB_DIGITS);
+    s.resize(top + (n - 1) * LIMB_DIGITS);
+    for (std::size_t i{1}; i < n; ++i)
     {
-        temp.clear();
-        for (std::size_t k{}; k < i; ++k)
-            temp.push_back('0');
-        int c{};
-        for (const auto& j : a)
+        auto v = l[n - 1 - i];
+        auto p = top + i * LIMB_DIGITS;
+        for (std::size_t k{}; k < LIMB_DIGITS; ++k)
         {
-            int d = (b[i] - '0') * (j - '0') + c;
-            temp.push_back(d % 10 + '0');
-            c = d / 10;
+            s[--p] = v % 10 + '0';
+            v /= 10;
         }
-        if (c > 0)
-            temp.push_back(c + '0');
-        std::reverse(temp.begin(), temp.end());
-        BigInt t;
-        t.value = temp;
-        z += t;
     }
-    return z;
 }
-BigInt operator/(const BigInt& x, const BigInt& y)
+
+// The limb kernels below take the base as a template argument, so that the base 2^32 words
+// of the bitwise operations share them
+
+// r[0..n) += a[0..k), k <= n
+template <std::uint64_t Base = LIMB_BASE>
+static void AddLimbs(Limb* r, std::size_t n, const Limb* a, std::size_t k)
 {
-    if (y.value == "0")
+    std::uint64_t c{};
+    std::size_t i{};
+    for (; i < k; ++i)
     {
-        throw std::runtime_error("Division by zero");
+        std::uint64_t d = std::uint64_t{r[i]} + a[i] + c;
+        c = d >= Base ? 1 : 0;
+        r[i] = static_cast<Limb>(d - c * Base);
     }
-    if (x.value == "0")
-        return ZERO;
-    if (x.sign && y.sign)
-        return Abs(x) / Abs(y);
-    if (x.sign)
+    for (; c != 0 && i < n; ++i)
     {
-        BigInt z = Abs(x) / y;
-        z.sign = true;
-        return z;
+        c = r[i] == Base - 1 ? 1 : 0;
+        r[i] = c ? 0 : r[i] + 1;
     }
-    if (y.sign)
+}
+// r[0..n) -= a[0..k), k <= n and r >= a
+template <std::uint64_t Base = LIMB_BASE>
+static void SubtractLimbs(Limb* r, std::size_t n, const Limb* a, std::size_t k)
+{
+    std::uint64_t c{};
+    std::size_t i{};
+    for (; i < k; ++i)
     {
-        BigInt z = x / Abs(y);
-        z.sign = true;
-        return z;
+        std::uint64_t s = a[i] + c;
+        c = r[i] < s ? 1 : 0;
+        r[i] = static_cast<Limb>(r[i] + c * Base - s);
     }
-    if (x.value == y.value)
-        return ONE;
-    if (y.value == "1")
-        return x;
-    if (x < y)
-        return ZERO;
-    BigInt rem;
-    rem.value = std::string(x.value.cbegin(), x.value.cbegin() + y.value.length());
-    if (rem < y)
-        rem.value.push_back(x.value[y.value.length()]);
-    auto i = rem.value.length();
-    BigInt z;
-    while (rem >= y)
+    for (; c != 0 && i < n; ++i)
     {
-        rem -= y;
-        z += ONE;
+        c = r[i] == 0 ? 1 : 0;
+        r[i] = c ? static_cast<Limb>(Base - 1) : r[i] - 1;
     }
-    for (; i < x.value.length(); ++i)
+}
+
+// r[0..n+m) = a * b
+template <std::uint64_t Base = LIMB_BASE>
+static void MultiplySchoolbook(const Limb* a, std::size_t n, const Limb* b, std::size_t m, Limb* r)
+{
+    std::fill(r, r + n + m, 0);
+    for (std::size_t i{}; i < m; ++i)
     {
-        z.value.push_back('0');
-        if (rem.value == "0")
-            rem.value.clear();
-        rem.value.push_back(x.value[i]);
-        while (rem >= y)
+        std::uint64_t c{}, d = b[i];
+        if (d == 0)
+            continue;
+        for (std::size_t j{}; j < n; ++j)
         {
-            rem -= y;
-            BigInt w;
-            w.value = std::string(1, z.value.back());
-            z.value.back() = (w + ONE).value[0];
+            std::uint64_t t = r[i + j] + a[j] * d + c;
+            r[i + j] = static_cast<Limb>(t % Base);
+            c = t / Base;
         }
+        r[i + n] = static_cast<Limb>(c);
     }
-    return z;
 }
-BigInt operator%(const BigInt& x, const BigInt& y)
+
+// The asynchronous call running on this thread, if any. Safe points poll its stop predicate
+// and report progress within [first, last], the range of the current stage.
+struct AsyncCall
 {
-    if (y.value == "0")
+    const StopCondition* stop{};
+    const ProgressCallback* progress{};
+    double first = 0.;
+    double last = 1.;
+    int reported = -1; // permille
+};
+static thread_local AsyncCall* async_call = nullptr;
+
+static void Poll(AsyncCall* c, const double done, const double total)
+{
+    if ((*c->stop)())
+        throw Cancelled();
+    if (total > 0. && *c->progress)
     {
-        throw std::runtime_error("Division by zero");
+        auto p = c->first + (c->last - c->first) * std::min(done / total, 1.);
+        auto permille = static_cast<int>(p * 1000.);
+        if (permille > c->reported)
+        {
+            c->reported = permille;
+            (*c->progress)(p);
+        }
     }
-    if (x.sign && y.sign)
-        return Abs(x) % Abs(y);
-    if (x.value == "0")
-        return ZERO;
-    if (x.sign)
+}
+// Throws Cancelled once the asynchronous call is asked to stop, and reports done / total of
+// the current stage. Does nothing outside an asynchronous call.
+static inline void SafePoint(const double done = 0., const double total = 0.)
+{
+    if (async_call != nullptr)
+        Poll(async_call, done, total);
+}
+// Maps the progress of a stage to [from, to] of the enclosing one
+class ProgressStage
+{
+public:
+    ProgressStage(const double from, const double to)
+        : call(async_call)
     {
-        BigInt z = Abs(x) % y;
-        z.sign = true;
+        if (call == nullptr)
+            return;
+        first = call->first;
+        last = call->last;
+        call->first = first + (last - first) * from;
+        call->last = first + (last - first) * to;
+    }
+    ~ProgressStage()
+    {
+        if (call == nullptr)
+            return;
+        call->first = first;
+        call->last = last;
+    }
+    ProgressStage(const ProgressStage&)=delete;
+    ProgressStage& operator=(const ProgressStage&)=delete;
+private:
+    AsyncCall* call;
+    double first{}, last{};
+};
+
+// Work is shared by a pool of worker threads and the threads waiting on it, so a
+// task may itself run a parallel section without starving the pool.
+class ThreadPool
+{
+public:
+    static ThreadPool& Instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+    ~ThreadPool() {Stop();}
+
+    unsigned Size() const
+    {
+        auto n = size.load();
+        return n != 0 ? n : std::max(1u, std::thread::hardware_concurrency());
+    }
+    void Resize(const unsigned n)
+    {
+        Stop();
+        size = n;
+    }
+    void Run(std::vector<std::function<void()>>& tasks)
+    {
+        if (tasks.empty())
+            return;
+        Batch batch;
+        batch.pending = tasks.size();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (workers.size() + 1 < Size())
+                workers.emplace_back(&ThreadPool::Work, this);
+            for (std::size_t i{1}; i < tasks.size(); ++i)
+                queue.push_back({&tasks[i], &batch});
+        }
+        available.notify_all();
+        Execute({&tasks[0], &batch});
+        for (Task task; Pop(task);)
+        {
+            Execute(task);
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (batch.pending == 0)
+                break;
+        }
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done.wait(lock, [&batch]{return batch.pending == 0;});
+        if (batch.error)
+            std::rethrow_exception(batch.error);
+    }
+private:
+    struct Batch
+    {
+        std::size_t pending{};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    struct Task
+    {
+        std::function<void()>* f{};
+        Batch* batch{};
+    };
+
+    ThreadPool()=default;
+
+    bool Pop(Task& task)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty())
+            return false;
+        task = queue.front();
+        queue.pop_front();
+        return true;
+    }
+    static void Execute(const Task& task)
+    {
+        // The task may belong to another computation, which must not see this thread's stop
+        auto call = async_call;
+        async_call = nullptr;
+        std::exception_ptr error;
+        try
+        {
+            (*task.f)();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        async_call = call;
+        std::lock_guard<std::mutex> lock(task.batch->mutex);
+        if (error && !task.batch->error)
+            task.batch->error = error;
+        if (--task.batch->pending == 0)
+            task.batch->done.notify_all();
+    }
+    void Work()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this]{return stopping || !queue.empty();});
+                if (queue.empty())
+                    return;
+                task = queue.front();
+                queue.pop_front();
+            }
+            Execute(task);
+        }
+    }
+    void Stop()
+    {
+        std::vector<std::thread> old;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            old.swap(workers);
+        }
+        available.notify_all();
+        for (auto& t : old)
+            t.join();
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+
+    std::atomic<unsigned> size{0};
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<Task> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+static inline bool ParallelQ(const std::size_t digits)
+{
+    return digits >= parallel_threshold && ThreadPool::Instance().Size() > 1;
+}
+
+// r[0..n+m) = a * b
+template <std::uint64_t Base = LIMB_BASE>
+static void MultiplyLimbs(const Limb* a, std::size_t n, const Limb* b, std::size_t m, Limb* r)
+{
+    if (n < m)
+    {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m < karatsuba_threshold.load(std::memory_order_relaxed))
+    {
+        MultiplySchoolbook<Base>(a, n, b, m, r);
+        return;
+    }
+    if (2 * m <= n)
+    {
+        std::fill(r, r + n + m, 0);
+        std::vector<Limb> t(2 * m);
+        BIGINT_STATS_ALLOCATION(t.size() * sizeof(Limb));
+        for (std::size_t i{}; i < n; i += m)
+        {
+            auto k = std::min(m, n - i);
+            MultiplyLimbs<Base>(a + i, k, b, m, t.data());
+            AddLimbs<Base>(r + i, n + m - i, t.data(), k + m);
+        }
+        return;
+    }
+    // Karatsuba: a * b = z2 * B^2h + (z1 - z2 - z0) * B^h + z0
+    SafePoint();
+    auto h = n / 2;
+    auto na = n - h, nb = m - h;
+    std::vector<Limb> sa(na + 1), sb(std::max(h, nb) + 1);
+    std::copy(a + h, a + n, sa.begin());
+    AddLimbs<Base>(sa.data(), sa.size(), a, h);
+    if (nb >= h)
+    {
+        std::copy(b + h, b + m, sb.begin());
+        AddLimbs<Base>(sb.data(), sb.size(), b, h);
+    }
+    else
+    {
+        std::copy(b, b + h, sb.begin());
+        AddLimbs<Base>(sb.data(), sb.size(), b + h, nb);
+    }
+    std::vector<Limb> z1(sa.size() + sb.size());
+    BIGINT_STATS_ALLOCATION((sa.size() + sb.size() + z1.size()) * sizeof(Limb));
+    std::vector<std::function<void()>> parts{
+        [&]{MultiplyLimbs<Base>(a, h, b, h, r);},
+        [&]{MultiplyLimbs<Base>(a + h, na, b + h, nb, r + 2 * h);},
+        [&]{MultiplyLimbs<Base>(sa.data(), sa.size(), sb.data(), sb.size(), z1.data());}
+    };
+    if (ParallelQ(m * LIMB_DIGITS))
+        ThreadPool::Instance().Run(parts);
+    else
+        for (auto& part : parts)
+            part();
+    SubtractLimbs<Base>(z1.data(), z1.size(), r, 2 * h);
+    SubtractLimbs<Base>(z1.data(), z1.size(), r + 2 * h, na + nb);
+    AddLimbs<Base>(r + h, n + m - h, z1.data(), std::min(z1.size(), n + m - h));
+}
+
+// out = x * y for big-endian digit strings
+static void MultiplyMagnitude(std::string& out, const std::string& x, const std::string& y)
+{
+    if (std::min(x.length(), y.length()) < limb_threshold.load(std::memory_order_relaxed))
+    {
+        BIGINT_STATS_TIER(Schoolbook);
+        BIGINT_STATS_GROW(out, x.length() + y.length());
+        out.clear();
+        MulAddMagnitude(out, x, y);
+        std::reverse(out.begin(), out.end());
+        return;
+    }
+    std::vector<Limb> a, b;
+    ToLimbs(a, x);
+    ToLimbs(b, y);
+    std::vector<Limb> r(a.size() + b.size());
+    BIGINT_STATS_ALLOCATION(r.size() * sizeof(Limb));
+#ifdef BIGINT_STATS
+    auto m = std::min(a.size(), b.size());
+    if (m < karatsuba_threshold.load(std::memory_order_relaxed))
+        BIGINT_STATS_TIER(Schoolbook);
+    else if (ParallelQ(m * LIMB_DIGITS))
+        BIGINT_STATS_TIER(ParallelKaratsuba);
+    else
+        BIGINT_STATS_TIER(Karatsuba);
+#endif
+    MultiplyLimbs(a.data(), a.size(), b.data(), b.size(), r.data());
+    FromLimbs(out, r.data(), r.size());
+}
+
+// Calls f(begin, end) on the thread pool for chunks covering [0, n)
+template <typename F>
+static void ParallelFor(const std::size_t n, const F& f)
+{
+    auto& pool = ThreadPool::Instance();
+    auto chunks = std::min<std::size_t>(n, 4 * pool.Size());
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t c{}; c < chunks; ++c)
+        tasks.emplace_back([&f, c, n, chunks]{f(c * n / chunks, (c + 1) * n / chunks);});
+    pool.Run(tasks);
+}
+
+// Folds v pairwise, level by level, so that the operands of f stay of similar size.
+// Levels holding at least the parallel threshold of digits are spread over the pool.
+template <typename T, typename F, typename D>
+static T FoldBalanced(std::vector<T>& v, const F& f, const D& digits)
+{
+    // Each level works on operands twice as long as the one before, which takes Karatsuba
+    // about 3/2 of the time, so progress is weighted by 1.5^level
+    int levels{}, level{};
+    for (auto n = v.size(); n > 1; n = (n + 1) / 2)
+        ++levels;
+    while (v.size() > 1)
+    {
+        SafePoint(std::pow(1.5, level++) - 1., std::pow(1.5, levels) - 1.);
+        std::vector<T> next((v.size() + 1) / 2);
+        auto pairs = v.size() / 2;
+        auto step = [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                next[i] = f(v[2 * i], v[2 * i + 1]);
+        };
+        std::size_t total{};
+        for (const auto& x : v)
+            total += digits(x);
+        if (pairs > 1 && ParallelQ(total))
+            ParallelFor(pairs, step);
+        else
+            step(0, pairs);
+        if (v.size() % 2 == 1)
+            next.back() = std::move(v.back());
+        v.swap(next);
+    }
+    return std::move(v.front());
+}
+
+static inline std::size_t Digits(const BigInt& x)
+{
+    return x.get_value().length();
+}
+
+// Leaves for the product of the integers in [first, last], packed below 10^18
+static std::vector<BigInt> PackedRange(const std::uint64_t first, const std::uint64_t last)
+{
+    static constexpr std::uint64_t LIMIT = 1000000000000000000;
+    std::vector<BigInt> leaves;
+    std::uint64_t p{1};
+    for (auto i = first; i <= last; ++i)
+    {
+        if (p > LIMIT / i)
+        {
+            leaves.emplace_back(std::to_string(p));
+            p = 1;
+        }
+        p *= i;
+    }
+    leaves.emplace_back(std::to_string(p));
+    return leaves;
+}
+
+// Bitwise operations work on little-endian base 2^32 words of the magnitude
+using Word = std::uint32_t;
+static constexpr std::uint64_t WORD_BASE = std::uint64_t{1} << 32;
+
+// Conversions between bases of this many digits or fewer run digit by digit
+static constexpr std::size_t CONVERT_THRESHOLD = 64;
+
+// out = the From digits [in, in + n) in base To, by Horner's rule
+template <std::uint64_t From, std::uint64_t To>
+static void ConvertSchoolbook(std::vector<Limb>& out, const Limb* in, std::size_t n)
+{
+    out.clear();
+    for (auto i = n; i-- > 0;)
+    {
+        std::uint64_t c = in[i];
+        for (auto& d : out)
+        {
+            c += std::uint64_t{d} * From;
+            d = static_cast<Limb>(c % To);
+            c /= To;
+        }
+        for (; c != 0; c /= To)
+            out.push_back(static_cast<Limb>(c % To));
+    }
+}
+// out = the From digits [in, in + n) in base To, powers[j] holding From^(2^j) in base To.
+// The upper digits above the largest power of two below n are converted apart from the
+// lower ones and scaled by its power, so the products go through Karatsuba.
+template <std::uint64_t From, std::uint64_t To>
+static void ConvertSplit(std::vector<Limb>& out, const Limb* in, std::size_t n, const std::vector<std::vector<Limb>>& powers)
+{
+    while (n > 0 && in[n - 1] == 0)
+        --n;
+    if (n <= CONVERT_THRESHOLD)
+    {
+        ConvertSchoolbook<From, To>(out, in, n);
+        return;
+    }
+    std::size_t j{};
+    while (std::size_t{2} << j < n)
+        ++j;
+    auto k = std::size_t{1} << j;
+    std::vector<Limb> high, low;
+    ConvertSplit<From, To>(high, in + k, n - k, powers);
+    ConvertSplit<From, To>(low, in, k, powers);
+    const auto& p = powers[j];
+    out.assign(high.size() + p.size(), 0);
+    MultiplyLimbs<To>(high.data(), high.size(), p.data(), p.size(), out.data());
+    AddLimbs<To>(out.data(), out.size(), low.data(), low.size());
+    while (!out.empty() && out.back() == 0)
+        out.pop_back();
+}
+template <std::uint64_t From, std::uint64_t To>
+static void ConvertBase(std::vector<Limb>& out, const Limb* in, const std::size_t n)
+{
+    if (n <= CONVERT_THRESHOLD)
+    {
+        ConvertSchoolbook<From, To>(out, in, n);
+        return;
+    }
+    std::vector<std::vector<Limb>> powers(1);
+    for (auto c = From; c != 0; c /= To)
+        powers[0].push_back(static_cast<Limb>(c % To));
+    while (std::size_t{2} << (powers.size() - 1) < n)
+    {
+        const auto& p = powers.back();
+        std::vector<Limb> q(2 * p.size());
+        MultiplyLimbs<To>(p.data(), p.size(), p.data(), p.size(), q.data());
+        while (q.back() == 0)
+            q.pop_back();
+        powers.push_back(std::move(q));
+    }
+    ConvertSplit<From, To>(out, in, n, powers);
+}
+
+static void ToWords(std::vector<Word>& w, const std::string& s)
+{
+    std::vector<Limb> l;
+    ToLimbs(l, s);
+    ConvertBase<LIMB_BASE, WORD_BASE>(w, l.data(), l.size());
+}
+static void FromWords(std::string& s, const std::vector<Word>& w)
+{
+    std::vector<Limb> l;
+    ConvertBase<WORD_BASE, LIMB_BASE>(l, w.data(), w.size());
+    FromLimbs(s, l.data(), l.size());
+}
+
+// Two's complement words of x; the returned mask is the infinite sign extension
+static Word ToTwosComplement(std::vector<Word>& w, const std::string& value, const bool sign)
+{
+    ToWords(w, value);
+    if (!sign)
+        return 0;
+    // -x = ~(x - 1)
+    for (auto& d : w)
+        if (d-- != 0)
+            break;
+    for (auto& d : w)
+        d = ~d;
+    return ~Word{};
+}
+// Magnitude of the two's complement words w with sign extension mask
+static void FromTwosComplement(std::string& value, std::vector<Word>& w, const Word mask)
+{
+    if (mask != 0)
+    {
+        // -(~w + 1)
+        for (auto& d : w)
+            d = ~d;
+        auto i = std::size_t{};
+        for (; i < w.size() && ++w[i] == 0; ++i) {}
+        if (i == w.size())
+            w.push_back(1);
+    }
+    FromWords(value, w);
+}
+template <typename F>
+static bool BitwiseOp(std::string& value, const BigInt& x, const BigInt& y, const F& f)
+{
+    BIGINT_STATS_SCOPE(Bitwise, std::max(x.get_value().length(), y.get_value().length()));
+    std::vector<Word> a, b;
+    auto mask_a = ToTwosComplement(a, x.get_value(), x.get_sign());
+    auto mask_b = ToTwosComplement(b, y.get_value(), y.get_sign());
+    auto n = std::max(a.size(), b.size());
+    a.resize(n, mask_a);
+    b.resize(n, mask_b);
+    for (std::size_t i{}; i < n; ++i)
+        a[i] = f(a[i], b[i]);
+    auto mask = f(mask_a, mask_b);
+    FromTwosComplement(value, a, mask);
+    return mask != 0;
+}
+
+// Shifts of base 10^9 limbs by at most 32 bits per pass
+static constexpr int SHIFT_STEP = 32;
+
+static void ShiftLeftLimbs(std::vector<Limb>& l, const int s)
+{
+    std::uint64_t c{};
+    for (auto& d : l)
+    {
+        c += std::uint64_t{d} << s;
+        d = static_cast<Limb>(c % LIMB_BASE);
+        c /= LIMB_BASE;
+    }
+    for (; c != 0; c /= LIMB_BASE)
+        l.push_back(static_cast<Limb>(c % LIMB_BASE));
+}
+static void ShiftRightLimbs(std::vector<Limb>& l, const int s)
+{
+    std::uint64_t r{};
+    auto mask = (std::uint64_t{1} << s) - 1;
+    for (auto i = l.size(); i-- > 0;)
+    {
+        auto t = r * LIMB_BASE + l[i];
+        l[i] = static_cast<Limb>(t >> s);
+        r = t & mask;
+    }
+    while (!l.empty() && l.back() == 0)
+        l.pop_back();
+}
+
+// value = the digits [begin, end) of the base, without leading zeros
+static void DigitsToValue(std::string& value, const char* begin, const char* end, const int base)
+{
+    BIGINT_STATS_SCOPE(Parse, static_cast<std::size_t>(end - begin));
+    if (begin == end)
+    {
+        value = "0";
+        return;
+    }
+    if (base == 10)
+    {
+        value.assign(begin, end);
+        return;
+    }
+    if ((base & (base - 1)) == 0)
+    {
+        // Power-of-two bases pack the bits of each digit straight into words
+        int bits{};
+        while (1 << bits < base)
+            ++bits;
+        std::vector<Word> w;
+        w.reserve(static_cast<std::size_t>(end - begin) * bits / 32 + 1);
+        std::uint64_t acc{};
+        int n{};
+        for (auto p = end; p != begin;)
+        {
+            acc |= static_cast<std::uint64_t>(DigitValue(*--p)) << n;
+            n += bits;
+            if (n >= 32)
+            {
+                w.push_back(static_cast<Word>(acc));
+                acc >>= 32;
+                n -= 32;
+            }
+        }
+        if (n > 0)
+            w.push_back(static_cast<Word>(acc));
+        FromWords(value, w);
+        return;
+    }
+    // Other bases are accumulated into limbs, as many digits at a time as fit in a limb
+    std::size_t k{1};
+    for (std::uint64_t m = base; m * base <= LIMB_BASE; m *= base)
+        ++k;
+    std::vector<Limb> l;
+    auto p = begin;
+    for (auto len = static_cast<std::size_t>(end - begin) % k; p != end; len = k)
+    {
+        if (len == 0)
+            len = k;
+        std::uint64_t c{}, scale{1};
+        for (std::size_t i{}; i < len; ++i, ++p)
+        {
+            c = c * base + DigitValue(*p);
+            scale *= base;
+        }
+        for (auto& d : l)
+        {
+            c += d * scale;
+            d = static_cast<Limb>(c % LIMB_BASE);
+            c /= LIMB_BASE;
+        }
+        for (; c != 0; c /= LIMB_BASE)
+            l.push_back(static_cast<Limb>(c % LIMB_BASE));
+    }
+    FromLimbs(value, l.data(), l.size());
+}
+// Scans the whole of s, allowing whitespace around the number
+static IntegerSpan ScanWhole(std::string_view s, const int base)
+{
+    if (base < 2 || base > 36)
+    {
+        throw std::domain_error("Base is not in the range 2 to 36");
+    }
+    auto last = s.data() + s.size();
+    auto span = ScanInteger(s.data(), last, base);
+    if (!span.valid || !std::all_of(span.end, last, SpaceQ))
+    {
+        throw std::invalid_argument("ERROR: Not a number");
+    }
+    return span;
+}
+
+BigInt::BigInt(const char* s) : BigInt(std::string_view(s)) {}
+BigInt::BigInt(const std::string& s) : BigInt(std::string_view(s)) {}
+BigInt::BigInt(std::string&& s)
+    : value(std::move(s))
+{
+    // Parses in place, the buffer of s is kept
+    BIGINT_STATS_SCOPE(Parse, value.length());
+    auto first = value.data();
+    auto span = ScanWhole(value, 10);
+    if (span.begin == span.end)
+        value = "0";
+    else
+    {
+        value.erase(static_cast<std::size_t>(span.end - first));
+        value.erase(0, static_cast<std::size_t>(span.begin - first));
+    }
+    sign = span.sign && value != "0";
+}
+BigInt::BigInt(std::string_view s, const int base)
+{
+    auto span = ScanWhole(s, base);
+    DigitsToValue(value, span.begin, span.end, base);
+    sign = span.sign && value != "0";
+}
+
+BigInt& BigInt::operator=(const char* s)
+{
+    auto span = ScanWhole(s, 10);
+    DigitsToValue(value, span.begin, span.end, 10);
+    sign = span.sign && value != "0";
+    return *this;
+}
+std::from_chars_result FromChars(const char* first, const char* last, BigInt& x, const int base)
+{
+    if (base < 2 || base > 36)
+        return {first, std::errc::invalid_argument};
+    auto span = ScanInteger(first, last, base);
+    if (!span.valid)
+        return {first, std::errc::invalid_argument};
+    DigitsToValue(x.value, span.begin, span.end, base);
+    x.sign = span.sign && x.value != "0";
+    return {span.end, std::errc{}};
+}
+
+// Writes the digits of the magnitude value in the base into [first, last)
+static std::to_chars_result MagnitudeToChars(char* first, char* last, const std::string& value, const int base, const bool upper)
+{
+    if (base < 2 || base > 36)
+        return {last, std::errc::invalid_argument};
+    if (base == 10)
+    {
+        if (static_cast<std::size_t>(last - first) < value.length())
+            return {last, std::errc::value_too_large};
+        return {std::copy(value.begin(), value.end(), first), std::errc{}};
+    }
+    const char* symbols = upper ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+    // Digits are produced least significant first
+    std::string digits;
+    if ((base & (base - 1)) == 0)
+    {
+        int bits{};
+        while (1 << bits < base)
+            ++bits;
+        std::vector<Word> w;
+        ToWords(w, value);
+        std::uint64_t acc{};
+        int n{};
+        for (auto d : w)
+        {
+            acc |= std::uint64_t{d} << n;
+            for (n += 32; n >= bits; n -= bits, acc >>= bits)
+                digits.push_back(symbols[acc & (base - 1)]);
+        }
+        digits.push_back(symbols[acc]);
+    }
+    else
+    {
+        // Each pass divides the limbs by base^k and emits k digits
+        std::size_t k{1};
+        Limb m = base;
+        for (; std::uint64_t{m} * base <= LIMB_BASE; m *= base)
+            ++k;
+        std::vector<Limb> l;
+        ToLimbs(l, value);
+        while (!l.empty())
+        {
+            std::uint64_t r{};
+            for (auto i = l.size(); i-- > 0;)
+            {
+                r = r * LIMB_BASE + l[i];
+                l[i] = static_cast<Limb>(r / m);
+                r %= m;
+            }
+            while (!l.empty() && l.back() == 0)
+                l.pop_back();
+            for (std::size_t i{}; i < k; ++i, r /= base)
+                digits.push_back(symbols[r % base]);
+        }
+    }
+    while (digits.length() > 1 && digits.back() == '0')
+        digits.pop_back();
+    if (static_cast<std::size_t>(last - first) < digits.length())
+        return {last, std::errc::value_too_large};
+    return {std::copy(digits.rbegin(), digits.rend(), first), std::errc{}};
+}
+static inline std::size_t GroupSize(const int base)
+{
+    return base == 10 ? 3 : 4;
+}
+// Upper bound of the number of digits of the magnitude value in the base
+static std::size_t DigitCount(const std::string& value, const int base)
+{
+    if (base == 10 || base < 2 || base > 36)
+        return value.length();
+    return static_cast<std::size_t>(std::ceil(value.length() * std::log2(10.) / std::log2(base))) + 1;
+}
+// Inserts a separator between groups of digits in [first, end), which must have room for them
+static char* GroupDigits(char* first, char* end, const char separator, const int base)
+{
+    auto group = GroupSize(base);
+    auto n = static_cast<std::size_t>(end - first);
+    auto separators = (n - 1) / group;
+    auto out = end + separators;
+    auto result = out;
+    for (std::size_t i{}; separators != 0; ++i)
+    {
+        *--out = *--end;
+        if ((i + 1) % group == 0)
+        {
+            *--out = separator;
+            --separators;
+        }
+    }
+    return result;
+}
+static std::to_chars_result IntegerToChars(char* first, char* last, const BigInt& x, const FormatSpec& spec)
+{
+    BIGINT_STATS_SCOPE(Format, x.get_value().length());
+    auto p = first;
+    if (x.get_sign() || spec.plus)
+    {
+        if (p == last)
+            return {last, std::errc::value_too_large};
+        *p++ = x.get_sign() ? '-' : '+';
+    }
+    auto r = MagnitudeToChars(p, last, x.get_value(), spec.base, spec.upper);
+    if (r.ec != std::errc{} || spec.separator == '\0')
+        return r;
+    auto n = static_cast<std::size_t>(r.ptr - p);
+    if (static_cast<std::size_t>(last - r.ptr) < (n - 1) / GroupSize(spec.base))
+        return {last, std::errc::value_too_large};
+    return {GroupDigits(p, r.ptr, spec.separator, spec.base), std::errc{}};
+}
+// Length of at least pad characters of grouped zeros in front of a leading group of lead
+// digits. As in Python's format(), the zeros continue the groups and a separator never comes
+// first, so the result may be one longer than pad.
+static std::size_t GroupedPadding(std::size_t lead, const std::size_t pad, const std::size_t group)
+{
+    std::size_t n{};
+    for (; n < pad; ++n, ++lead)
+    {
+        if (lead == group)
+        {
+            ++n;
+            lead = 0;
+        }
+    }
+    return n;
+}
+// Pads the text [first, end) to the width of spec, sign is the length of its sign
+static std::to_chars_result Pad(char* first, char* end, char* last, const FormatSpec& spec, const std::size_t sign)
+{
+    auto n = static_cast<std::size_t>(end - first);
+    if (n >= spec.width)
+        return {end, std::errc{}};
+    auto pad = spec.width - n;
+    if (spec.zero && spec.align == '\0' && spec.separator != '\0')
+    {
+        auto digits = first + sign;
+        auto lead = static_cast<std::size_t>(std::find_if(digits, end, [&spec](const char c){return c == spec.separator || c == ' ';}) - digits);
+        auto group = GroupSize(spec.base);
+        pad = GroupedPadding(lead, pad, group);
+        if (static_cast<std::size_t>(last - end) < pad)
+            return {last, std::errc::value_too_large};
+        std::copy_backward(digits, end, end + pad);
+        for (auto p = digits + pad; p != digits; ++lead)
+        {
+            if (lead == group)
+            {
+                *--p = spec.separator;
+                lead = 0;
+            }
+            *--p = '0';
+        }
+        return {end + pad, std::errc{}};
+    }
+    if (static_cast<std::size_t>(last - end) < pad)
+        return {last, std::errc::value_too_large};
+    if (spec.zero && spec.align == '\0')
+    {
+        std::copy_backward(first + sign, end, end + pad);
+        std::fill(first + sign, first + sign + pad, '0');
+        return {end + pad, std::errc{}};
+    }
+    auto align = spec.align == '\0' ? '>' : spec.align;
+    auto before = align == '>' ? pad : align == '^' ? pad / 2 : 0;
+    std::copy_backward(first, end, end + before);
+    std::fill(first, first + before, spec.fill);
+    std::fill(end + before, end + pad, spec.fill);
+    return {end + pad, std::errc{}};
+}
+
+std::to_chars_result ToChars(char* first, char* last, const BigInt& x, const int base)
+{
+    FormatSpec spec;
+    spec.base = base;
+    return IntegerToChars(first, last, x, spec);
+}
+std::to_chars_result ToChars(char* first, char* last, const BigInt& x, const FormatSpec& spec)
+{
+    auto r = IntegerToChars(first, last, x, spec);
+    if (r.ec != std::errc{})
+        return r;
+    return Pad(first, r.ptr, last, spec, x.get_sign() || spec.plus ? 1 : 0);
+}
+std::size_t FormattedSize(const BigInt& x, const int base)
+{
+    return DigitCount(x.get_value(), base) + (x.get_sign() ? 1 : 0);
+}
+// Size of the number without padding
+static std::size_t UnpaddedSize(const BigInt& x, const FormatSpec& spec)
+{
+    auto n = DigitCount(x.get_value(), spec.base);
+    if (spec.separator != '\0')
+        n += (n - 1) / GroupSize(spec.base);
+    return n + (x.get_sign() || spec.plus ? 1 : 0);
+}
+// Size of a text of the given size padded as Pad does, when its leading number x is written
+// with spec
+static std::size_t PaddedSize(const std::size_t size, const BigInt& x, const FormatSpec& spec)
+{
+    if (size >= spec.width)
+        return size;
+    if (!spec.zero || spec.align != '\0' || spec.separator == '\0')
+        return spec.width;
+    // Grouped zeros may take one more character, exactly known only for decimal digits
+    if (spec.base != 10)
+        return spec.width + 1;
+    auto group = GroupSize(10);
+    return size + GroupedPadding((x.get_value().length() - 1) % group + 1, spec.width - size, group);
+}
+std::size_t FormattedSize(const BigInt& x, const FormatSpec& spec)
+{
+    return PaddedSize(UnpaddedSize(x, spec), x, spec);
+}
+BigInt& BigInt::operator+=(const BigInt& x)
+{
+    *this = *this + x;
+    return *this;
+}
+BigInt& BigInt::operator-=(const BigInt& x)
+{
+    *this = *this - x;
+    return *this;
+}
+BigInt& BigInt::operator*=(const BigInt& x)
+{
+    *this = *this * x;
+    return *this;
+}
+BigInt& BigInt::operator/=(const BigInt& x)
+{
+    *this = *this / x;
+    return *this;
+}
+BigInt& BigInt::operator%=(const BigInt& x)
+{
+    *this = *this % x;
+    return *this;
+}
+BigInt& BigInt::operator^=(const int p)
+{
+    *this = *this ^ p;
+    return *this;
+}
+BigInt& BigInt::operator&=(const BigInt& x)
+{
+    *this = *this & x;
+    return *this;
+}
+BigInt& BigInt::operator|=(const BigInt& x)
+{
+    *this = *this | x;
+    return *this;
+}
+BigInt& BigInt::operator<<=(const int p)
+{
+    *this = *this << p;
+    return *this;
+}
+BigInt& BigInt::operator>>=(const int p)
+{
+    *this = *this >> p;
+    return *this;
+}
+
+const std::string& BigInt::get_value() const {return value;}
+bool BigInt::get_sign() const {return sign;}
+
+std::ostream& operator<<(std::ostream& out, const BigInt& x)
+{
+    BIGINT_STATS_SCOPE(Format, x.value.length());
+    if (x.sign)
+        return out << '-' << x.value;
+    return out << x.value;
+}
+
+BigInt operator+(const BigInt& x, const BigInt& y)
+{
+
+    if (!x.sign && y.sign)
+        return x - Abs(y);
+    if (x.sign && !y.sign)
+        return y - Abs(x);
+    BIGINT_STATS_SCOPE(Add, std::max(x.value.length(), y.value.length()));
+    const auto& a = x.value.length() >= y.value.length() ? x.value : y.value;
+    const auto& b = x.value.length() >= y.value.length() ? y.value : x.value;
+    BigInt z;
+    BIGINT_STATS_GROW(z.value, a.length() + 1);
+    z.value.reserve(a.length() + 1);
+    z.value = a;
+    AddMagnitude(z.value, b);
+    if (x.sign && y.sign)
+        z.sign = true;
+    return z;
+}
+BigInt operator-(const BigInt& x, const BigInt& y)
+{
+    if (!x.sign && y.sign)
+        return x + Abs(y);
+    if (x.sign && !y.sign)
+    {
+        BigInt z = Abs(x) + y;
+        z.sign = true;
+        return z;
+    }
+    if (x.sign && y.sign)
+        return Abs(y) - Abs(x);
+    if (x < y)
+    {
+        BigInt z = y - x;
+        z.sign = true;
+        return z;
+    }
+    BIGINT_STATS_SCOPE(Subtract, x.value.length());
+    BigInt z;
+    z.value = x.value;
+    SubtractMagnitude(z.value, y.value);
+    return z;
+}
+BigInt operator-(const BigInt& x)
+{
+    BigInt y{x};
+    y.sign = !y.sign;
+    return y;
+}
+BigInt operator*(const BigInt& x, const BigInt& y)
+{
+    if (x.sign && y.sign)
+        return Abs(x) * Abs(y);
+    if (x.value == "0" || y.value == "0")
+        return ZERO;
+    if (x.sign)
+    {
+        BigInt z = Abs(x) * y;
+        z.sign = true;
+        return z;
+    }
+    if (y.sign)
+    {
+        BigInt z = x * Abs(y);
+        z.sign = true;
+        return z;
+    }
+    BIGINT_STATS_SCOPE(Multiply, std::max(x.value.length(), y.value.length()));
+    if (x.value == "1")
+        return y;
+    if (y.value == "1")
+        return x;
+    BigInt z;
+    MultiplyMagnitude(z.value, x.value, y.value);
+    return z;
+}
+BigInt operator/(const BigInt& x, const BigInt& y)
+{
+    if (y.value == "0")
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    if (x.value == "0")
+        return ZERO;
+    if (x.sign && y.sign)
+        return Abs(x) / Abs(y);
+    if (x.sign)
+    {
+        BigInt z = Abs(x) / y;
+        z.sign = z.value != "0";
+        return z;
+    }
+    if (y.sign)
+    {
+        BigInt z = x / Abs(y);
+        z.sign = z.value != "0";
+        return z;
+    }
+    BIGINT_STATS_SCOPE(Divide, x.value.length());
+    if (x.value == y.value)
+        return ONE;
+    if (y.value == "1")
+        return x;
+    if (x < y)
+        return ZERO;
+    Scratch rem;
+    BigInt z;
+    DivideMagnitude(&z.value, *rem, x.value, y.value);
+    return z;
+}
+BigInt operator%(const BigInt& x, const BigInt& y)
+{
+    if (y.value == "0")
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    if (x.sign && y.sign)
+        return Abs(x) % Abs(y);
+    if (x.value == "0")
+        return ZERO;
+    if (x.sign)
+    {
+        BigInt z = Abs(x) % y;
+        z.sign = z.value != "0";
+        return z;
+    }
+    if (y.sign)
+        return x % Abs(y);
+    BIGINT_STATS_SCOPE(Remainder, x.value.length());
+    if (x.value == y.value || y.value == "1")
+        return ZERO;
+    if (x < y)
+        return x;
+    BigInt rem;
+    RemainderMagnitude(rem.value, x.value, y.value);
+    return rem;
+}
+BigInt operator^(const BigInt& x, const int y)
+{
+    if (y < 0)
+    {
+        throw std::domain_error("Power is a negative integer");
+    }
+    if (x.value == "0" && y == 0)
+    {
+        throw std::domain_error("Indeterminate expression 0^0 encountered");
+    }
+    if (x.value == "0")
+        return x;
+    if (y == 0)
+        return ONE;
+    if (x.sign)
+    {
+        if (y % 2 == 0)
+            return Abs(x) ^ y;
+        else
+        {
+            BigInt z = Abs(x) ^ y;
+            z.sign = true;
+            return z;
+        }
+    }
+    if (y == 1)
+        return x;
+    BIGINT_STATS_SCOPE(Pow, x.value.length());
+    BigInt z{ONE}, b{x};
+    auto bits = std::floor(std::log2(static_cast<double>(y))) + 1.;
+    for (int e{y}, i{};; ++i)
+    {
+        SafePoint(i, bits);
+        if (e % 2 == 1)
+            z *= b;
+        e /= 2;
+        if (e == 0)
+            break;
+        b *= b;
+    }
+    return z;
+}
+
+BigInt operator&(const BigInt& x, const BigInt& y)
+{
+    BigInt z;
+    z.sign = BitwiseOp(z.value, x, y, [](Word a, Word b){return a & b;});
+    return z;
+}
+BigInt operator|(const BigInt& x, const BigInt& y)
+{
+    BigInt z;
+    z.sign = BitwiseOp(z.value, x, y, [](Word a, Word b){return a | b;});
+    return z;
+}
+BigInt BitXor(const BigInt& x, const BigInt& y)
+{
+    BigInt z;
+    z.sign = BitwiseOp(z.value, x, y, [](Word a, Word b){return a ^ b;});
+    return z;
+}
+BigInt operator~(const BigInt& x)
+{
+    BIGINT_STATS_SCOPE(Bitwise, x.value.length());
+    // ~x = -x - 1
+    BigInt z{x};
+    if (x.sign)
+    {
+        SubtractMagnitude(z.value, "1");
+        z.sign = false;
+    }
+    else
+    {
+        AddMagnitude(z.value, "1");
+        z.sign = true;
+    }
+    return z;
+}
+BigInt operator<<(const BigInt& x, const int y)
+{
+    if (y < 0)
+    {
+        throw std::domain_error("Shift count is a negative integer");
+    }
+    if (x.value == "0" || y == 0)
+        return x;
+    BIGINT_STATS_SCOPE(Shift, x.value.length());
+    // Long shifts multiply by a power of two computed by squaring
+    if (static_cast<std::size_t>(y) > shift_multiply_threshold.load(std::memory_order_relaxed))
+        return x * (TWO ^ y);
+    std::vector<Limb> l;
+    ToLimbs(l, x.value);
+    for (int s{y}; s > 0; s -= SHIFT_STEP)
+        ShiftLeftLimbs(l, std::min(s, SHIFT_STEP));
+    BigInt z;
+    FromLimbs(z.value, l.data(), l.size());
+    z.sign = x.sign;
+    return z;
+}
+BigInt operator>>(const BigInt& x, const int y)
+{
+    if (y < 0)
+    {
+        throw std::domain_error("Shift count is a negative integer");
+    }
+    if (x.value == "0" || y == 0)
+        return x;
+    BIGINT_STATS_SCOPE(Shift, x.value.length());
+    // Rounds toward negative infinity: -x >> y = -(((x - 1) >> y) + 1)
+    BigInt z{x};
+    if (x.sign)
+        SubtractMagnitude(z.value, "1");
+    auto passes = static_cast<std::size_t>(y / SHIFT_STEP);
+    auto limbs = (z.value.length() + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    // Long shifts convert to words once and drop whole words, which beats a pass per 32 bits
+    // from about 8 sqrt(limbs) passes on
+    if (passes * passes > 64 * limbs)
+    {
+        std::vector<Word> w;
+        ToWords(w, z.value);
+        auto s = y % 32;
+        auto i = std::min(passes, w.size());
+        w.erase(w.begin(), w.begin() + static_cast<std::ptrdiff_t>(i));
+        if (s != 0)
+        {
+            for (std::size_t j{}; j < w.size(); ++j)
+                w[j] = w[j] >> s | (j + 1 < w.size() ? w[j + 1] << (32 - s) : 0);
+        }
+        FromWords(z.value, w);
+    }
+    else
+    {
+        std::vector<Limb> l;
+        ToLimbs(l, z.value);
+        for (int s{y}; s > 0 && !l.empty(); s -= SHIFT_STEP)
+            ShiftRightLimbs(l, std::min(s, SHIFT_STEP));
+        FromLimbs(z.value, l.data(), l.size());
+    }
+    if (x.sign)
+        AddMagnitude(z.value, "1");
+    return z;
+}
+
+bool operator>=(const BigInt& x, const BigInt& y)
+{
+    return !(x < y);
+}
+bool operator<=(const BigInt& x, const BigInt& y)
+{
+    return !(y < x);
+}
+bool operator==(const BigInt& x, const BigInt& y)
+{
+    if (x.sign == y.sign && x.value == y.value)
+        return true;
+    return false;
+}
+bool operator!=(const BigInt& x, const BigInt& y)
+{
+    return !(x == y);
+}
+bool operator>(const BigInt& x, const BigInt& y)
+{
+    return y < x;
+}
+bool operator<(const BigInt& x, const BigInt& y)
+{
+    if (x.sign != y.sign)
+        return x.sign;
+    auto c = CompareMagnitude(x.value, y.value);
+    // x and y are negative
+    if (x.sign)
+        return c > 0;
+    // x and y are positive
+    return c < 0;
+}
+
+BigInt Abs(const BigInt& x)
+{
+    BigInt y{x};
+    y.sign = false;
+    return y;
+}
+BigInt Factorial(const int n)
+{
+    if (n < 0)
+    {
+        throw std::domain_error("Factorial of a negative integer");
+    }
+    BIGINT_STATS_SCOPE(Factorial, static_cast<std::size_t>(n));
+    auto& cache = MemoCache::Instance();
+    if (n < CACHE_STRIDE || !cache.Enabled())
+        return Product(PackedRange(2, n));
+    // Resumes from the nearest checkpoint and stores the last one passed
+    auto c = cache.Find(CacheFunction::Factorial, n);
+    auto start = c ? c->n : 1, last = n / CACHE_STRIDE * CACHE_STRIDE;
+    auto z = c ? c->values[0] : ONE;
+    if (last > start)
+    {
+        z *= Product(PackedRange(start + 1, last));
+        cache.Insert(CacheFunction::Factorial, last, {z});
+    }
+    if (n > last)
+        z *= Product(PackedRange(last + 1, n));
+    return z;
+}
+BigInt GCD(const BigInt& x, const BigInt& y)
+{
+    if(x.value == "0" && y.value == "0")
+        return ZERO;
+    BIGINT_STATS_SCOPE(GCD, std::max(x.value.length(), y.value.length()));
+    Scratch a, b, r;
+    *a = x.value;
+    *b = y.value;
+    auto length = static_cast<double>(b->length());
+    while (*b != "0")
+    {
+        SafePoint(length - static_cast<double>(b->length()), length);
+        RemainderMagnitude(*r, *a, *b);
+        std::swap(*a, *b);
+        std::swap(*b, *r);
+    }
+    BigInt z;
+    z.value = *a;
+    return z;
+}
+BigInt LCM(const BigInt& x, const BigInt& y)
+{
+    if (x.value == "0" || y.value == "0")
+        return ZERO;
+    return Abs(y) * (Abs(x) / GCD(x, y));
+}
+BigInt ISqrt(const BigInt& x)
+{
+    if (x.sign)
+    {
+        throw std::domain_error("Integer square root of a negative integer");
+    }
+    if (x.value == "0" || x.value == "1")
+        return x;
+    BIGINT_STATS_SCOPE(ISqrt, x.value.length());
+    // Newton's iteration decreases to the root from a first guess above it, taken from
+    // the square root of the leading digits, so it runs about log2(digits / 16) times
+    auto lead = std::min<std::size_t>(x.value.length(), 17);
+    if ((x.value.length() - lead) % 2 != 0)
+        --lead;
+    auto root = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(std::stoull(x.value.substr(0, lead)))));
+    BigInt x0{std::to_string(root + 2) + std::string((x.value.length() - lead) / 2, '0')};
+    auto x1 = (x0 + x / x0) / TWO;
+    while (!(x1 >= x0))
+    {
+        x0 = x1;
+        x1 = (x0 + x / x0) / TWO;
+    }
+    return x0;
+}
+BigInt Fibonacci(const int n)
+{
+    if (n < 0)
+    {
+        throw std::domain_error("Fibonacci of a negative integer");
+    }
+    if (n == 0)
+        return ZERO;
+    BIGINT_STATS_SCOPE(Fibonacci, static_cast<std::size_t>(n));
+    auto& cache = MemoCache::Instance();
+    if (n < CACHE_STRIDE || !cache.Enabled())
+    {
+        Scratch a;
+        *a = "0";
+        BigInt b{ONE};
+        for (int i = 2; i <= n; ++i)
+        {
+            SafePoint(i, n);
+            AddMagnitude(*a, b.value);
+            std::swap(*a, b.value);
+        }
+        return b;
+    }
+    // a = F(k) and b = F(k + 1) from the nearest checkpoint; the last one passed is stored
+    auto c = cache.Find(CacheFunction::Fibonacci, n);
+    auto k = c ? c->n : 0, last = n / CACHE_STRIDE * CACHE_STRIDE;
+    auto a = c ? c->values[0] : ZERO, b = c ? c->values[1] : ONE;
+    if (last > k)
+    {
+        for (; k < last; ++k)
+        {
+            SafePoint(k, n);
+            AddMagnitude(a.value, b.value);
+            std::swap(a.value, b.value);
+        }
+        cache.Insert(CacheFunction::Fibonacci, last, {a, b});
+    }
+    for (; k < n; ++k)
+    {
+        SafePoint(k, n);
+        AddMagnitude(a.value, b.value);
+        std::swap(a.value, b.value);
+    }
+    return a;
+}
+BigInt Binomial(const int n, const int k)
+{
+    if (n < 0 || k < 0 || k > n)
+        return ZERO;
+    if (n == k || k == 0)
+        return ONE;
+    BIGINT_STATS_SCOPE(Binomial, static_cast<std::size_t>(n));
+    auto m = std::min(k, n - k);
+    return Product(PackedRange(n - m + 1, n)) / Factorial(m);
+}
+bool EvenQ(const BigInt& x)
+{
+    return (x.value.back() - '0') % 2 == 0;
+}
+bool OddQ(const BigInt& x)
+{
+    return !EvenQ(x);
+}
+std::size_t IntegerLength(const BigInt& x)
+{
+    return x.value.length();
+}
+std::size_t BitLength(const BigInt& x)
+{
+    // Negative numbers count the bits of -x - 1, as their two's complement does
+    std::vector<Word> w;
+    if (x.sign)
+        ToTwosComplement(w, x.value, x.sign);
+    else
+        ToWords(w, x.value);
+    auto mask = x.sign ? ~Word{} : Word{};
+    while (!w.empty() && w.back() == mask)
+        w.pop_back();
+    if (w.empty())
+        return 0;
+    std::size_t n{(w.size() - 1) * 32};
+    for (auto top = w.back() ^ mask; top != 0; top >>= 1)
+        ++n;
+    return n;
+}
+std::size_t PopCount(const BigInt& x)
+{
+    std::vector<Word> w;
+    ToWords(w, x.value);
+    std::size_t n{};
+    for (auto d : w)
+        for (; d != 0; d &= d - 1)
+            ++n;
+    return n;
+}
+bool TestBit(const BigInt& x, const int k)
+{
+    if (k < 0)
+    {
+        throw std::domain_error("Bit index is a negative integer");
+    }
+    // 10^(k+1) is a multiple of 2^(k+1), so the low k + 1 bits depend only on the low k + 1
+    // digits, and bit 0 on the last digit alone
+    if (k == 0)
+        return OddQ(x);
+    auto n = static_cast<std::size_t>(k) + 1;
+    auto low = n < x.value.length() ? x.value.substr(x.value.length() - n) : x.value;
+    if (low.find_first_not_of('0') == std::string::npos)
+        return false;
+    std::vector<Word> w;
+    auto mask = ToTwosComplement(w, low, x.sign);
+    auto i = static_cast<std::size_t>(k / 32);
+    auto d = i < w.size() ? w[i] : mask;
+    return (d >> (k % 32) & 1) != 0;
+}
+BigInt Product(std::vector<BigInt> v)
+{
+    if (v.empty())
+        return ONE;
+    return FoldBalanced(v, [](const BigInt& x, const BigInt& y){return x * y;}, Digits);
+}
+BigInt Sum(std::vector<BigInt> v)
+{
+    if (v.empty())
+        return ZERO;
+    return FoldBalanced(v, [](const BigInt& x, const BigInt& y){return x + y;}, Digits);
+}
+BigInt LCM(std::vector<BigInt> v)
+{
+    if (v.empty())
+        return ONE;
+    return FoldBalanced(v, [](const BigInt& x, const BigInt& y){return LCM(x, y);}, Digits);
+}
+std::string Approx(const BigInt& x, const std::size_t n)
+{
+    auto length = x.value.length();
+    auto k = std::clamp<std::size_t>(n, 1, length);
+    while (k > 1 && x.value[k - 1] == '0')
+        --k;
+    char exponent[24];
+    auto e = std::to_chars(exponent, exponent + sizeof(exponent), length - 1).ptr;
+    std::string s;
+    s.reserve(k + 10 + (e - exponent));
+    if (x.sign)
+        s.push_back('-');
+    s.push_back(x.value[0]);
+    if (k > 1)
+    {
+        s.push_back('.');
+        s.append(x.value, 1, k - 1);
+    }
+    s.append(" x 10 ^ ");
+    s.append(exponent, e);
+    return s;
+}
+// value += y * z on a signed magnitude, where the product has the sign s. y or z may be value.
+static void MulAccumulate(std::string& value, bool& sign, const std::string& y, const std::string& z, const bool s)
+{
+    auto add = value == "0" || sign == s;
+    if (add && &value != &y && &value != &z
+        && std::min(y.length(), z.length()) < limb_threshold.load(std::memory_order_relaxed))
+    {
+        BIGINT_STATS_TIER(Schoolbook);
+        std::reverse(value.begin(), value.end());
+        MulAddMagnitude(value, y, z);
+        std::reverse(value.begin(), value.end());
+        sign = s;
+        return;
+    }
+    Scratch p;
+    MultiplyMagnitude(*p, y, z);
+    if (add)
+    {
+        AddMagnitude(value, *p);
+        sign = s;
+    }
+    else if (CompareMagnitude(value, *p) >= 0)
+    {
+        // The product cancels part of the value, which keeps its sign unless it reaches zero
+        SubtractMagnitude(value, *p);
+        sign = sign && value != "0";
+    }
+    else
+    {
+        SubtractMagnitude(*p, value);
+        value.swap(*p);
+        sign = s;
+    }
+}
+BigInt& AddMul(BigInt& x, const BigInt& y, const BigInt& z)
+{
+    if (y.value == "0" || z.value == "0")
+        return x;
+    BIGINT_STATS_SCOPE(AddMul, std::max(y.value.length(), z.value.length()));
+    MulAccumulate(x.value, x.sign, y.value, z.value, y.sign != z.sign);
+    return x;
+}
+BigInt& SubMul(BigInt& x, const BigInt& y, const BigInt& z)
+{
+    if (y.value == "0" || z.value == "0")
+        return x;
+    BIGINT_STATS_SCOPE(SubMul, std::max(y.value.length(), z.value.length()));
+    MulAccumulate(x.value, x.sign, y.value, z.value, y.sign == z.sign);
+    return x;
+}
+BigInt MulMod(const BigInt& x, const BigInt& y, const BigInt& m)
+{
+    if (m.value == "0")
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    BigInt z;
+    if (x.value == "0" || y.value == "0" || m.value == "1")
         return z;
+    BIGINT_STATS_SCOPE(MulMod, std::max(x.value.length(), y.value.length()));
+    Scratch p;
+    MultiplyMagnitude(*p, x.value, y.value);
+    RemainderMagnitude(z.value, *p, m.value);
+    // The sign rules of operator%: the remainder of two negatives is positive
+    z.sign = x.sign != y.sign && !m.sign && z.value != "0";
+    return z;
+}
+
+// Runs f(i) for i in [0, n), spread over the pool when the operands are large enough
+template <typename F>
+static void ForEachPair(const BigInt* x, const BigInt* y, const std::size_t n, const F& f)
+{
+    std::size_t total{};
+    for (std::size_t i{}; i < n; ++i)
+        total += IntegerLength(x[i]) + IntegerLength(y[i]);
+    auto step = [&f](std::size_t begin, std::size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+            f(i);
+    };
+    if (n > 1 && ParallelQ(total))
+        ParallelFor(n, step);
+    else
+        step(0, n);
+}
+
+void AddN(const BigInt* x, const BigInt* y, BigInt* out, const std::size_t n)
+{
+    ForEachPair(x, y, n, [x, y, out](std::size_t i)
+    {
+        const BigInt* a = &x[i];
+        const BigInt* b = &y[i];
+        if (CompareMagnitude(a->value, b->value) < 0)
+            std::swap(a, b);
+        auto& z = out[i];
+        auto sign = a->sign;
+        auto subtract = a->sign != b->sign;
+        Scratch t;
+        if (&z == b)
+            *t = b->value;
+        const auto& v = &z == b ? *t : b->value;
+        if (&z != a)
+            z.value = a->value;
+        if (subtract)
+            SubtractMagnitude(z.value, v);
+        else
+            AddMagnitude(z.value, v);
+        z.sign = sign && z.value != "0";
+    });
+}
+void MulN(const BigInt* x, const BigInt* y, BigInt* out, const std::size_t n)
+{
+    ForEachPair(x, y, n, [x, y, out](std::size_t i)
+    {
+        Scratch p;
+        MultiplyMagnitude(*p, x[i].value, y[i].value);
+        auto sign = x[i].sign != y[i].sign && *p != "0";
+        std::swap(out[i].value, *p);
+        out[i].sign = sign;
+    });
+}
+void ModN(const BigInt* x, const BigInt* y, BigInt* out, const std::size_t n)
+{
+    for (std::size_t i{}; i < n; ++i)
+        if (y[i].value == "0")
+        {
+            throw std::runtime_error("Division by zero");
+        }
+    ForEachPair(x, y, n, [x, y, out](std::size_t i)
+    {
+        Scratch r;
+        RemainderMagnitude(*r, x[i].value, y[i].value);
+        auto sign = x[i].sign && !y[i].sign && *r != "0";
+        std::swap(out[i].value, *r);
+        out[i].sign = sign;
+    });
+}
+
+// Arithmetic modulo an odd n > 1 on the words of the bitwise operations, in Montgomery
+// form x * R mod n with R = 2^(32k) for k words, so that products are reduced without
+// division
+class Montgomery
+{
+public:
+    explicit Montgomery(const BigInt& n)
+    {
+        ToWords(m, n.get_value());
+        k = m.size();
+        // -1 / n mod 2^32 by Newton's iteration, each step doubles the correct low bits
+        Word inv = m[0];
+        for (int i = 0; i < 4; ++i)
+            inv *= 2 - m[0] * inv;
+        minv = 0 - inv;
+        t.resize(2 * k + 1);
+        ToWords(r2, ((ONE << static_cast<int>(64 * k)) % n).get_value());
+        r2.resize(k);
+        ToWords(one, ((ONE << static_cast<int>(32 * k)) % n).get_value());
+        one.resize(k);
+    }
+
+    const std::vector<Word>& One() const {return one;}
+    // x in [0, n)
+    std::vector<Word> Convert(const BigInt& x) const
+    {
+        std::vector<Word> w;
+        ToWords(w, x.get_value());
+        w.resize(k);
+        Multiply(w, w, r2);
+        return w;
+    }
+    BigInt Revert(const std::vector<Word>& a) const
+    {
+        std::vector<Word> unit(k), w;
+        unit[0] = 1;
+        Multiply(w, a, unit);
+        std::string s;
+        FromWords(s, w);
+        return BigInt(std::move(s));
+    }
+
+    // r = a * b / R mod n, r may be a or b. The product and the multiples of n that clear
+    // its low words are summed column by column; the low and high halves of the 64-bit
+    // products go to separate accumulators, so no carry chain runs through the products.
+    void Multiply(std::vector<Word>& r, const std::vector<Word>& a, const std::vector<Word>& b) const
+    {
+        auto q = t.data(), out = t.data() + k;
+        auto ap = a.data(), bp = b.data(), mp = m.data();
+        std::uint64_t lo{}, hi{};
+        auto accumulate = [&lo, &hi](const std::uint64_t p)
+        {
+            lo += p & 0xFFFFFFFFu;
+            hi += p >> 32;
+        };
+        for (std::size_t i{}; i < k; ++i)
+        {
+            for (std::size_t j{}; j < i; ++j)
+            {
+                accumulate(std::uint64_t{ap[j]} * bp[i - j]);
+                accumulate(std::uint64_t{q[j]} * mp[i - j]);
+            }
+            accumulate(std::uint64_t{ap[i]} * bp[0]);
+            q[i] = static_cast<Word>(static_cast<Word>(lo) * minv);
+            accumulate(std::uint64_t{q[i]} * mp[0]);
+            lo = (lo >> 32) + hi;
+            hi = 0;
+        }
+        for (auto i = k; i < 2 * k; ++i)
+        {
+            for (auto j = i - k + 1; j < k; ++j)
+            {
+                accumulate(std::uint64_t{ap[j]} * bp[i - j]);
+                accumulate(std::uint64_t{q[j]} * mp[i - j]);
+            }
+            out[i - k] = static_cast<Word>(lo);
+            lo = (lo >> 32) + hi;
+            hi = 0;
+        }
+        out[k] = static_cast<Word>(lo);
+        // out < 2n
+        if (out[k] != 0 || !Less(out))
+            SubtractModulus(out);
+        r.assign(out, out + k);
+    }
+    void Add(std::vector<Word>& r, const std::vector<Word>& a, const std::vector<Word>& b) const
+    {
+        std::uint64_t c{};
+        for (std::size_t j{}; j < k; ++j)
+        {
+            c += std::uint64_t{a[j]} + b[j];
+            r[j] = static_cast<Word>(c);
+            c >>= 32;
+        }
+        if (c != 0 || !Less(r.data()))
+            SubtractModulus(r.data());
+    }
+    void Subtract(std::vector<Word>& r, const std::vector<Word>& a, const std::vector<Word>& b) const
+    {
+        std::uint64_t borrow{};
+        for (std::size_t j{}; j < k; ++j)
+        {
+            auto d = std::uint64_t{a[j]} - b[j] - borrow;
+            r[j] = static_cast<Word>(d);
+            borrow = d >> 63;
+        }
+        if (borrow != 0)
+        {
+            std::uint64_t c{};
+            for (std::size_t j{}; j < k; ++j)
+            {
+                c += std::uint64_t{r[j]} + m[j];
+                r[j] = static_cast<Word>(c);
+                c >>= 32;
+            }
+        }
+    }
+    // r = r / 2 mod n
+    void Half(std::vector<Word>& r) const
+    {
+        std::uint64_t c{};
+        if (r[0] & 1)
+            for (std::size_t j{}; j < k; ++j)
+            {
+                c += std::uint64_t{r[j]} + m[j];
+                r[j] = static_cast<Word>(c);
+                c >>= 32;
+            }
+        for (std::size_t j{}; j < k; ++j)
+            r[j] = r[j] >> 1 | static_cast<Word>((j + 1 < k ? r[j + 1] : c) << 31);
+    }
+    // r = a^e for an exponent of plain words, with a window of 4 bits
+    void Pow(std::vector<Word>& r, const std::vector<Word>& a, const std::vector<Word>& e) const
+    {
+        std::vector<std::vector<Word>> table(16, one);
+        for (std::size_t i{1}; i < table.size(); ++i)
+            Multiply(table[i], table[i - 1], a);
+        r = one;
+        bool started{};
+        for (auto i = e.size() * 8; i-- > 0;)
+        {
+            if (started)
+                for (int s{}; s < 4; ++s)
+                    Multiply(r, r, r);
+            auto nibble = e[i / 8] >> (i % 8 * 4) & 15;
+            if (nibble != 0)
+            {
+                Multiply(r, r, table[nibble]);
+                started = true;
+            }
+        }
+    }
+private:
+    bool Less(const Word* a) const
+    {
+        for (auto j = k; j-- > 0;)
+            if (a[j] != m[j])
+                return a[j] < m[j];
+        return false;
+    }
+    void SubtractModulus(Word* a) const
+    {
+        std::uint64_t borrow{};
+        for (std::size_t j{}; j < k; ++j)
+        {
+            auto d = std::uint64_t{a[j]} - m[j] - borrow;
+            a[j] = static_cast<Word>(d);
+            borrow = d >> 63;
+        }
+    }
+
+    std::vector<Word> m, r2, one;
+    std::size_t k;
+    Word minv;
+    mutable std::vector<Word> t;
+};
+
+static inline bool ZeroQ(const std::vector<Word>& w)
+{
+    return std::all_of(w.begin(), w.end(), [](Word d){return d == 0;});
+}
+// Divides w by its largest power of two and returns the exponent
+static std::size_t RemovePowerOfTwo(std::vector<Word>& w)
+{
+    std::size_t s{};
+    while (s / 32 < w.size() && (w[s / 32] >> (s % 32) & 1) == 0)
+        ++s;
+    auto q = s / 32, b = s % 32;
+    for (std::size_t j{}; j < w.size(); ++j)
+    {
+        auto lo = j + q < w.size() ? w[j + q] : 0;
+        auto hi = j + q + 1 < w.size() ? w[j + q + 1] : 0;
+        w[j] = b == 0 ? lo : static_cast<Word>(lo >> b | hi << (32 - b));
+    }
+    return s;
+}
+
+// Remainder of the digits value modulo a small m, nine digits at a time
+static std::uint32_t ModSmall(const std::string& value, const std::uint32_t m)
+{
+    std::uint64_t r{};
+    auto k = value.length() % 9 == 0 ? 9 : value.length() % 9;
+    for (std::size_t i{}; i < value.length(); i += k, k = 9)
+    {
+        std::uint64_t chunk{}, scale{1};
+        for (std::size_t j{}; j < k; ++j)
+        {
+            chunk = chunk * 10 + static_cast<std::uint64_t>(value[i + j] - '0');
+            scale *= 10;
+        }
+        r = (r * scale + chunk) % m;
+    }
+    return static_cast<std::uint32_t>(r);
+}
+
+// Primes below 2^16, for trial division and sieving
+static const std::vector<std::uint32_t>& SmallPrimes()
+{
+    static const std::vector<std::uint32_t> primes = []
+    {
+        constexpr std::uint32_t limit = 1 << 16;
+        std::vector<bool> composite(limit);
+        std::vector<std::uint32_t> p;
+        for (std::uint32_t i{2}; i < limit; ++i)
+        {
+            if (composite[i])
+                continue;
+            p.push_back(i);
+            for (auto j = i * i; j < limit; j += i)
+                composite[j] = true;
+        }
+        return p;
+    }();
+    return primes;
+}
+static constexpr std::uint32_t TRIAL_DIVISION_LIMIT = 1000;
+
+// Jacobi symbol (a/n) for odd n
+static int Jacobi(std::uint64_t a, std::uint64_t n)
+{
+    int j{1};
+    a %= n;
+    while (a != 0)
+    {
+        for (; a % 2 == 0; a /= 2)
+            if (n % 8 == 3 || n % 8 == 5)
+                j = -j;
+        std::swap(a, n);
+        if (a % 4 == 3 && n % 4 == 3)
+            j = -j;
+        a %= n;
+    }
+    return n == 1 ? j : 0;
+}
+static int Jacobi(long long a, const BigInt& n)
+{
+    int j{1};
+    auto n8 = ModSmall(n.get_value(), 8);
+    if (a < 0)
+    {
+        a = -a;
+        if (n8 % 4 == 3)
+            j = -j;
+    }
+    for (; a % 2 == 0; a /= 2)
+        if (n8 == 3 || n8 == 5)
+            j = -j;
+    // Quadratic reciprocity
+    if (a % 4 == 3 && n8 % 4 == 3)
+        j = -j;
+    auto r = ModSmall(n.get_value(), static_cast<std::uint32_t>(a));
+    return j * Jacobi(r, static_cast<std::uint64_t>(a));
+}
+
+// Strong probable prime test to the base a (in Montgomery form) for odd n
+static bool StrongProbablePrimeQ(const Montgomery& mg, const BigInt& n, const std::vector<Word>& a)
+{
+    // n - 1 = d * 2^s
+    std::vector<Word> d;
+    ToWords(d, n.get_value());
+    d[0] -= 1;
+    auto s = RemovePowerOfTwo(d);
+    std::vector<Word> x, minus_one(mg.One().size());
+    mg.Subtract(minus_one, minus_one, mg.One());
+    mg.Pow(x, a, d);
+    if (x == mg.One() || x == minus_one)
+        return true;
+    for (std::size_t r{1}; r < s; ++r)
+    {
+        mg.Multiply(x, x, x);
+        if (x == minus_one)
+            return true;
+        if (x == mg.One())
+            return false;
+    }
+    return false;
+}
+
+// Strong Lucas probable prime test with Selfridge's parameters for odd n > 1 that is
+// not a small prime
+static bool StrongLucasProbablePrimeQ(const Montgomery& mg, const BigInt& n)
+{
+    // The first D in 5, -7, 9, -11, ... with (D/n) = -1, then P = 1 and Q = (1 - D) / 4
+    long long D{5};
+    for (int i{};; ++i, D = D > 0 ? -(D + 2) : -D + 2)
+    {
+        auto j = Jacobi(D, n);
+        if (j == -1)
+            break;
+        if (j == 0 && n != BigInt(std::to_string(D < 0 ? -D : D)))
+            return false;
+        // No such D exists for squares
+        if (i == 8)
+        {
+            auto r = ISqrt(n);
+            if (r * r == n)
+                return false;
+        }
+    }
+    auto residue = [&n](const long long v)
+    {
+        auto x = BigInt(std::to_string(v)) % n;
+        return x.get_sign() ? x + n : x;
+    };
+    auto dm = mg.Convert(residue(D)), q = mg.Convert(residue((1 - D) / 4));
+    // n + 1 = d * 2^s
+    std::vector<Word> d;
+    ToWords(d, (n + ONE).get_value());
+    auto s = RemovePowerOfTwo(d);
+    // U_1 = 1, V_1 = P = 1; doubling: U_2k = U_k V_k, V_2k = V_k^2 - 2Q^k; increment:
+    // U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+    auto u = mg.One(), v = mg.One(), qk = q, t = u;
+    auto bits = d.size() * 32;
+    while ((d[(bits - 1) / 32] >> ((bits - 1) % 32) & 1) == 0)
+        --bits;
+    for (auto i = bits - 1; i-- > 0;)
+    {
+        mg.Multiply(u, u, v);
+        mg.Multiply(v, v, v);
+        mg.Subtract(v, v, qk);
+        mg.Subtract(v, v, qk);
+        mg.Multiply(qk, qk, qk);
+        if ((d[i / 32] >> (i % 32) & 1) != 0)
+        {
+            mg.Multiply(t, dm, u);
+            mg.Add(t, t, v);
+            mg.Half(t);
+            mg.Add(u, u, v);
+            mg.Half(u);
+            std::swap(v, t);
+            mg.Multiply(qk, qk, q);
+        }
+    }
+    if (ZeroQ(u) || ZeroQ(v))
+        return true;
+    for (std::size_t r{1}; r < s; ++r)
+    {
+        mg.Multiply(v, v, v);
+        mg.Subtract(v, v, qk);
+        mg.Subtract(v, v, qk);
+        if (ZeroQ(v))
+            return true;
+        mg.Multiply(qk, qk, qk);
+    }
+    return false;
+}
+
+// Baillie-PSW test for odd n > 1: no composite passing it is known
+static bool BailliePSWQ(const BigInt& n)
+{
+    Montgomery mg(n);
+    return StrongProbablePrimeQ(mg, n, mg.Convert(TWO)) && StrongLucasProbablePrimeQ(mg, n);
+}
+
+// Marks the odd numbers start + 2i, i < w, with a factor below 2^16 other than themselves
+static std::vector<char> SieveWindow(const BigInt& start, const std::size_t w)
+{
+    std::vector<char> composite(w);
+    const auto& v = start.get_value();
+    // Windows that can hold sieving primes only mark multiples from p^2 on
+    auto small = v.length() <= 18 ? std::stoull(v) : std::numeric_limits<std::uint64_t>::max();
+    for (auto p : SmallPrimes())
+    {
+        if (p == 2)
+            continue;
+        std::uint64_t i{};
+        if (std::uint64_t{p} * p > small)
+        {
+            if (std::uint64_t{p} * p >= small + 2 * w)
+                break;
+            i = (std::uint64_t{p} * p - small) / 2;
+        }
+        else
+        {
+            // start + 2i = 0 (mod p)
+            auto r = ModSmall(v, p);
+            i = (p - r) % p * ((p + 1) / 2) % p;
+        }
+        for (; i < w; i += p)
+            composite[i] = 1;
+    }
+    return composite;
+}
+static inline std::size_t SieveWindowSize(const BigInt& n)
+{
+    // Prime gaps near n average ln n, about 2.3 times the number of digits
+    return std::max<std::size_t>(1024, 4 * n.get_value().length());
+}
+
+static std::mt19937_64& RandomGenerator()
+{
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    return generator;
+}
+
+BigInt PowerMod(const BigInt& x, const BigInt& e, const BigInt& m)
+{
+    if (m.value == "0")
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    if (e.sign)
+    {
+        throw std::domain_error("Power is a negative integer");
+    }
+    if (x.value == "0" && e.value == "0")
+    {
+        throw std::domain_error("Indeterminate expression 0^0 encountered");
+    }
+    auto n = Abs(m);
+    if (n.value == "1")
+        return ZERO;
+    auto b = x % n;
+    if (b.sign)
+        b += n;
+    std::vector<Word> exponent;
+    ToWords(exponent, e.value);
+    if (OddQ(n))
+    {
+        Montgomery mg(n);
+        std::vector<Word> r;
+        mg.Pow(r, mg.Convert(b), exponent);
+        return mg.Revert(r);
+    }
+    BigInt z{ONE};
+    for (auto i = exponent.size() * 32; i-- > 0;)
+    {
+        z = MulMod(z, z, n);
+        if ((exponent[i / 32] >> (i % 32) & 1) != 0)
+            z = MulMod(z, b, n);
+    }
+    return z;
+}
+bool PrimeQ(const BigInt& n, const int rounds)
+{
+    if (n.sign || n.value == "0" || n.value == "1")
+        return false;
+    // Trial division settles numbers below TRIAL_DIVISION_LIMIT^2
+    for (auto p : SmallPrimes())
+    {
+        if (p >= TRIAL_DIVISION_LIMIT)
+            break;
+        if (ModSmall(n.value, p) == 0)
+            return n.value == std::to_string(p);
+    }
+    if (n.value.length() < 7)
+        return true;
+    Montgomery mg(n);
+    if (!StrongProbablePrimeQ(mg, n, mg.Convert(TWO)) || !StrongLucasProbablePrimeQ(mg, n))
+        return false;
+    for (int i{}; i < rounds; ++i)
+    {
+        auto a = RandomBelow(n - BigInt("3")) + TWO;
+        if (!StrongProbablePrimeQ(mg, n, mg.Convert(a)))
+            return false;
+    }
+    return true;
+}
+BigInt NextPrime(const BigInt& n)
+{
+    if (n < TWO)
+        return TWO;
+    auto start = n + ONE;
+    if (EvenQ(start))
+        start += ONE;
+    auto w = SieveWindowSize(n);
+    for (;; start += BigInt(std::to_string(2 * w)))
+    {
+        auto composite = SieveWindow(start, w);
+        for (std::size_t i{}; i < w; ++i)
+        {
+            if (composite[i])
+                continue;
+            auto c = start + BigInt(std::to_string(2 * i));
+            if (BailliePSWQ(c))
+                return c;
+        }
+    }
+}
+BigInt PrevPrime(const BigInt& n)
+{
+    if (n <= TWO)
+    {
+        throw std::domain_error("No prime is less than the argument");
+    }
+    if (n.value == "3")
+        return TWO;
+    auto top = n - ONE;
+    if (EvenQ(top))
+        top -= ONE;
+    auto w = SieveWindowSize(n);
+    const BigInt three{"3"};
+    for (;;)
+    {
+        // The window of odd numbers ends at top and stays above 2
+        auto span = BigInt(std::to_string(2 * (w - 1)));
+        auto start = top - span;
+        if (start < three)
+        {
+            start = three;
+            w = static_cast<std::size_t>((std::stoull(top.value) - 3) / 2 + 1);
+        }
+        auto composite = SieveWindow(start, w);
+        for (auto i = w; i-- > 0;)
+        {
+            if (composite[i])
+                continue;
+            auto c = start + BigInt(std::to_string(2 * i));
+            if (BailliePSWQ(c))
+                return c;
+        }
+        top = start - TWO;
+    }
+}
+BigInt RandomBelow(const BigInt& n)
+{
+    if (n.sign || n.value == "0")
+    {
+        throw std::domain_error("Upper bound is not positive");
+    }
+    // The leading digits are drawn up to those of n and the others uniformly; draws of n
+    // or more are rejected, which is rare unless n is short
+    auto k = std::min<std::size_t>(n.value.length(), 18);
+    auto top = std::stoull(n.value.substr(0, k));
+    std::uniform_int_distribution<std::uint64_t> lead(0, top), chunk(0, 999999999999999999ull);
+    auto& g = RandomGenerator();
+    std::string s(n.value.length(), '0');
+    char buffer[20];
+    for (;;)
+    {
+        auto a = lead(g);
+        auto length = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(a));
+        std::fill(s.begin(), s.begin() + static_cast<std::ptrdiff_t>(k), '0');
+        std::copy(buffer, buffer + length, s.begin() + static_cast<std::ptrdiff_t>(k) - length);
+        for (auto i = k; i < s.length(); i += 18)
+        {
+            auto c = chunk(g);
+            for (auto j = std::min(i + 18, s.length()); j-- > i; c /= 10)
+                s[j] = static_cast<char>('0' + c % 10);
+        }
+        if (a < top || s < n.value)
+            return BigInt(std::string(s));
+    }
+}
+void SeedRandom(const std::uint64_t seed)
+{
+    RandomGenerator().seed(seed);
+}
+
+// Factorization: trial division, then Pollard-Brent rho, then ECM on Montgomery curves
+static constexpr std::size_t RHO_ITERATIONS = 1 << 18;
+static constexpr std::size_t RHO_BATCH = 128;
+// Stage 1 bounds and curve counts that find factors of 15, 20, ... 40 digits with good odds
+struct EcmLevel
+{
+    std::uint64_t b1;
+    std::size_t curves;
+};
+static constexpr EcmLevel ECM_LEVELS[] = {{2000, 25}, {11000, 90}, {50000, 300},
+                                          {250000, 700}, {1000000, 1800}, {3000000, 5100}};
+static constexpr std::uint64_t ECM_STAGE2_FACTOR = 100;
+// Stage 2 pairs giant steps mW with baby steps j < W / 2 coprime to W
+static constexpr std::uint64_t ECM_WHEEL = 2310;
+static constexpr std::uint64_t ECM_SIEVE_STEPS = 64;
+
+static inline BigInt WordsToBigInt(const std::vector<Word>& w)
+{
+    std::string s;
+    FromWords(s, w);
+    return BigInt(std::move(s));
+}
+
+// Primality of the numbers lo + i, i < n, for lo + n <= 2^32
+static std::vector<char> PrimeFlags(const std::uint64_t lo, const std::size_t n)
+{
+    std::vector<char> prime(n, 1);
+    for (auto i = lo; i < 2 && i < lo + n; ++i)
+        prime[i - lo] = 0;
+    for (auto p : SmallPrimes())
+    {
+        std::uint64_t pp = std::uint64_t{p} * p;
+        if (pp >= lo + n)
+            break;
+        for (auto j = std::max(pp, (lo + p - 1) / p * p); j < lo + n; j += p)
+            prime[j - lo] = 0;
+    }
+    return prime;
+}
+
+// Brent's variant of Pollard's rho with x -> x^2 + c; the differences are multiplied
+// together RHO_BATCH at a time so that one GCD serves the whole batch. Returns a proper
+// factor of n, or ONE after the given number of iterations.
+static BigInt PollardBrent(const BigInt& n, const std::uint64_t c, const std::size_t iterations)
+{
+    Montgomery mg(n);
+    auto a = mg.Convert(BigInt(std::to_string(c)));
+    auto y = mg.Convert(TWO), x = y, ys = y, d = y, q = mg.One();
+    auto f = [&mg, &a](std::vector<Word>& v)
+    {
+        mg.Multiply(v, v, v);
+        mg.Add(v, v, a);
+    };
+    BigInt g{ONE};
+    for (std::size_t r{1}, steps{}; g == ONE && steps < iterations; r *= 2)
+    {
+        x = y;
+        for (std::size_t i{}; i < r; ++i)
+            f(y);
+        for (std::size_t k{}; k < r && g == ONE; k += RHO_BATCH)
+        {
+            ys = y;
+            for (std::size_t i{}; i < std::min(RHO_BATCH, r - k); ++i)
+            {
+                f(y);
+                mg.Subtract(d, x, y);
+                mg.Multiply(q, q, d);
+            }
+            // q holds the product times R, which is prime to n
+            g = GCD(WordsToBigInt(q), n);
+        }
+        steps += 2 * r;
+    }
+    if (g == n)
+    {
+        // The batch caught every factor at once: step through it again one by one
+        do
+        {
+            f(ys);
+            mg.Subtract(d, x, ys);
+            g = GCD(WordsToBigInt(d), n);
+        }
+        while (g == ONE);
+    }
+    return g == n ? ONE : g;
+}
+
+// A curve By^2 = x^3 + (A/C)x^2 + x mod n from Suyama's parametrization, whose group order
+// has a factor 12. Points are kept as X:Z and multiplied by Montgomery's ladder.
+class EllipticCurve
+{
+public:
+    struct Point
+    {
+        std::vector<Word> x, z;
+    };
+
+    EllipticCurve(const Montgomery& mg, const BigInt& n, const std::uint64_t sigma) : mg(mg)
+    {
+        auto reduce = [&n](const BigInt& v)
+        {
+            auto r = v % n;
+            return r.get_sign() ? r + n : r;
+        };
+        BigInt s(std::to_string(sigma));
+        auto u = reduce(s * s - BigInt("5")), v = reduce(BigInt("4") * s);
+        auto u3 = MulMod(MulMod(u, u, n), u, n), v3 = MulMod(MulMod(v, v, n), v, n);
+        auto w = reduce(v - u);
+        // A + 2C = (v - u)^3 (3u + v) and 4C = 16 u^3 v
+        a24 = mg.Convert(MulMod(MulMod(MulMod(w, w, n), w, n), reduce(BigInt("3") * u + v), n));
+        c24 = mg.Convert(MulMod(BigInt("16") * u3 % n, v, n));
+        start = {mg.Convert(u3), mg.Convert(v3)};
+        t0 = t1 = t2 = mg.One();
+        r0 = r1 = start;
+    }
+
+    const Point& Start() const {return start;}
+    // r = 2p
+    void Double(Point& r, const Point& p)
+    {
+        mg.Add(t0, p.x, p.z);
+        mg.Subtract(t1, p.x, p.z);
+        mg.Multiply(t0, t0, t0);
+        mg.Multiply(t1, t1, t1);
+        mg.Multiply(r.z, c24, t1);
+        mg.Multiply(r.x, r.z, t0);
+        mg.Subtract(t0, t0, t1);
+        mg.Multiply(t1, a24, t0);
+        mg.Add(r.z, r.z, t1);
+        mg.Multiply(r.z, r.z, t0);
+    }
+    // r = p + q given d = p - q; r may be p or q but not d
+    void Add(Point& r, const Point& p, const Point& q, const Point& d)
+    {
+        mg.Add(t0, p.x, p.z);
+        mg.Subtract(t1, q.x, q.z);
+        mg.Multiply(t0, t0, t1);
+        mg.Subtract(t1, p.x, p.z);
+        mg.Add(t2, q.x, q.z);
+        mg.Multiply(t1, t1, t2);
+        mg.Add(t2, t0, t1);
+        mg.Subtract(t1, t0, t1);
+        mg.Multiply(t2, t2, t2);
+        mg.Multiply(t1, t1, t1);
+        mg.Multiply(r.x, d.z, t2);
+        mg.Multiply(r.z, d.x, t1);
+    }
+    // p = kp for k > 0
+    void Multiply(Point& p, const std::uint64_t k)
+    {
+        if (k == 1)
+            return;
+        r0 = p;
+        Double(r1, p);
+        int top{63};
+        while ((k >> top & 1) == 0)
+            --top;
+        for (auto i = top; i-- > 0;)
+        {
+            if ((k >> i & 1) != 0)
+            {
+                Add(r0, r1, r0, p);
+                Double(r1, r1);
+            }
+            else
+            {
+                Add(r1, r1, r0, p);
+                Double(r0, r0);
+            }
+        }
+        p = r0;
+    }
+private:
+    const Montgomery& mg;
+    std::vector<Word> a24, c24, t0, t1, t2;
+    Point start, r0, r1;
+};
+
+// One curve with stage 1 bound b1 and stage 2 bound b2 <= 2^32, where primes flags the
+// primes up to b1. Returns a proper factor of n, or ONE when the curve fails or stop is raised.
+static BigInt Ecm(const BigInt& n, const std::uint64_t sigma, const std::uint64_t b1, const std::uint64_t b2,
+                  const std::vector<char>& primes, const std::atomic<bool>& stop)
+{
+    Montgomery mg(n);
+    EllipticCurve curve(mg, n, sigma);
+    auto q = curve.Start();
+    auto factor = [&n](const std::vector<Word>& w)
+    {
+        auto g = GCD(WordsToBigInt(w), n);
+        return g == n ? ONE : g;
+    };
+    // Stage 1: q = kq for k the product of the prime powers up to b1
+    for (std::uint64_t p{2}, count{}; p <= b1; ++p)
+    {
+        if (!primes[p])
+            continue;
+        auto k = p;
+        while (k <= b1 / p)
+            k *= p;
+        curve.Multiply(q, k);
+        if (++count % 1024 == 0 && stop)
+            return ONE;
+    }
+    // A zero z modulo every factor of n at once leaves nothing for stage 2 either
+    if (ZeroQ(q.z))
+        return ONE;
+    auto g = factor(q.z);
+    if (g != ONE)
+        return g;
+    // Stage 2: a prime p = mW +- j has pq = 0 on the curve modulo a factor of n exactly
+    // when X(mWq) Z(jq) - X(jq) Z(mWq) vanishes modulo that factor
+    std::vector<std::uint64_t> baby;
+    std::vector<EllipticCurve::Point> babies;
+    {
+        auto twice = q, step = q, previous = q, next = q;
+        curve.Double(twice, q);
+        for (std::uint64_t j{1}; j < ECM_WHEEL / 2; j += 2)
+        {
+            if (j > 1)
+            {
+                // jq = (j - 2)q + 2q with difference (j - 4)q, which is q up to sign for j = 3
+                curve.Add(next, step, twice, previous);
+                previous = step;
+                step = next;
+            }
+            if (std::gcd(j, ECM_WHEEL) == 1)
+            {
+                baby.push_back(j);
+                babies.push_back(step);
+            }
+        }
+    }
+    auto m0 = std::max<std::uint64_t>(1, b1 / ECM_WHEEL), m1 = b2 / ECM_WHEEL + 1;
+    auto wheel = q, giant = q, previous = q, next = q;
+    curve.Multiply(wheel, ECM_WHEEL);
+    curve.Multiply(giant, m0 * ECM_WHEEL);
+    if (m0 > 1)
+        curve.Multiply(previous, (m0 - 1) * ECM_WHEEL);
+    auto product = mg.One(), t = product, u = product;
+    std::vector<char> prime;
+    std::uint64_t base{};
+    for (auto m = m0; m <= m1; ++m)
+    {
+        if ((m - m0) % ECM_SIEVE_STEPS == 0)
+        {
+            if (stop)
+                return ONE;
+            base = m * ECM_WHEEL - ECM_WHEEL / 2;
+            prime = PrimeFlags(base, static_cast<std::size_t>((ECM_SIEVE_STEPS + 1) * ECM_WHEEL));
+        }
+        auto centre = m * ECM_WHEEL, offset = centre - base;
+        for (std::size_t i{}; i < baby.size(); ++i)
+        {
+            auto j = baby[i];
+            auto high = prime[offset + j] && centre + j > b1 && centre + j <= b2;
+            auto low = prime[offset - j] && centre - j > b1 && centre - j <= b2;
+            if (!high && !low)
+                continue;
+            mg.Multiply(t, giant.x, babies[i].z);
+            mg.Multiply(u, babies[i].x, giant.z);
+            mg.Subtract(t, t, u);
+            mg.Multiply(product, product, t);
+        }
+        // (m + 1)Wq = mWq + Wq with difference (m - 1)Wq
+        if (m == 1)
+            curve.Double(next, giant);
+        else
+            curve.Add(next, giant, wheel, previous);
+        std::swap(previous, giant);
+        std::swap(giant, next);
+    }
+    return factor(product);
+}
+
+// A proper factor of composite n without factors below 2^16, found by rho and then by ECM
+// with growing bounds, running as many curves at once as there are threads
+static BigInt FindFactor(const BigInt& n)
+{
+    auto d = PollardBrent(n, 1, RHO_ITERATIONS);
+    if (d != ONE)
+        return d;
+    std::atomic<bool> found{false};
+    std::mutex mutex;
+    BigInt factor{ONE};
+    std::uniform_int_distribution<std::uint64_t> draw(6, std::numeric_limits<std::uint32_t>::max());
+    auto& pool = ThreadPool::Instance();
+    for (std::size_t level{};; level = std::min(level + 1, std::size(ECM_LEVELS) - 1))
+    {
+        auto [b1, curves] = ECM_LEVELS[level];
+        auto primes = PrimeFlags(0, static_cast<std::size_t>(b1) + 1);
+        for (std::size_t done{}; done < curves;)
+        {
+            auto batch = std::min<std::size_t>(pool.Size(), curves - done);
+            std::vector<std::function<void()>> tasks;
+            for (std::size_t i{}; i < batch; ++i)
+            {
+                // Curves are drawn on this thread, so SeedRandom makes runs repeatable
+                auto sigma = draw(RandomGenerator());
+                tasks.emplace_back([&, sigma, b1 = b1]
+                {
+                    auto g = Ecm(n, sigma, b1, ECM_STAGE2_FACTOR * b1, primes, found);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (g != ONE && !found)
+                    {
+                        factor = g;
+                        found = true;
+                    }
+                });
+            }
+            pool.Run(tasks);
+            if (found)
+                return factor;
+            done += batch;
+        }
+    }
+}
+
+std::vector<std::pair<BigInt, int>> FactorInteger(const BigInt& x)
+{
+    if (x.value == "0")
+        return {{ZERO, 1}};
+    std::vector<std::pair<BigInt, int>> factors;
+    if (x.sign)
+        factors.push_back({BigInt("-1"), 1});
+    auto n = Abs(x);
+    if (n.value == "1")
+    {
+        if (factors.empty())
+            factors.push_back({ONE, 1});
+        return factors;
+    }
+    // Trial division, stopping once p^2 exceeds what is left
+    for (auto p : SmallPrimes())
+    {
+        if (n.value.length() < 10 && std::uint64_t{p} * p > std::stoull(n.value))
+            break;
+        if (ModSmall(n.value, p) != 0)
+            continue;
+        BigInt d(std::to_string(p));
+        int e{};
+        for (; ModSmall(n.value, p) == 0; ++e)
+            n /= d;
+        factors.push_back({d, e});
+    }
+    // The cofactor has no factors below 2^16, so below 2^32 it is prime
+    std::vector<std::pair<BigInt, int>> large;
+    std::vector<BigInt> pending;
+    if (n.value != "1")
+        pending.push_back(std::move(n));
+    while (!pending.empty())
+    {
+        auto m = std::move(pending.back());
+        pending.pop_back();
+        if (m.value.length() < 10 || BailliePSWQ(m))
+        {
+            auto i = std::find_if(large.begin(), large.end(), [&m](const auto& f){return f.first == m;});
+            if (i != large.end())
+                ++i->second;
+            else
+                large.push_back({std::move(m), 1});
+            continue;
+        }
+        auto d = FindFactor(m);
+        pending.push_back(m / d);
+        pending.push_back(std::move(d));
+    }
+    std::sort(large.begin(), large.end());
+    factors.insert(factors.end(), large.begin(), large.end());
+    return factors;
+}
+
+// Binary format: a version byte, then per integer an LEB128 varint holding
+// (limb count << 1 | sign) followed by the little-endian base 10^9 limbs, 4 bytes each
+static constexpr unsigned char BINARY_VERSION = 1;
+static constexpr std::size_t LIMB_BYTES = 4;
+
+static inline void CorruptBinary()
+{
+    throw std::invalid_argument("ERROR: Corrupt binary data");
+}
+static inline std::size_t VarintSize(std::uint64_t v)
+{
+    std::size_t n{1};
+    for (; v >= 0x80; v >>= 7)
+        ++n;
+    return n;
+}
+static inline unsigned char* WriteVarint(unsigned char* p, std::uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        *p++ = static_cast<unsigned char>(v | 0x80);
+    *p++ = static_cast<unsigned char>(v);
+    return p;
+}
+static inline void StoreLimb(unsigned char* p, const Limb v)
+{
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+}
+static inline Limb LoadLimb(const unsigned char* p)
+{
+    return Limb{p[0]} | Limb{p[1]} << 8 | Limb{p[2]} << 16 | Limb{p[3]} << 24;
+}
+static inline std::size_t LimbCount(const std::string& s)
+{
+    return s == "0" ? 0 : (s.length() + LIMB_DIGITS - 1) / LIMB_DIGITS;
+}
+
+static inline std::size_t IntegerBinarySize(const BigInt& x)
+{
+    auto n = LimbCount(x.get_value());
+    return VarintSize(std::uint64_t{n} << 1) + n * LIMB_BYTES;
+}
+static unsigned char* WriteInteger(unsigned char* p, const BigInt& x)
+{
+    const auto& s = x.get_value();
+    auto n = LimbCount(s);
+    p = WriteVarint(p, std::uint64_t{n} << 1 | (x.get_sign() && n != 0 ? 1 : 0));
+    auto end = s.length();
+    for (std::size_t i{}; i < n; ++i, p += LIMB_BYTES)
+    {
+        auto begin = end > LIMB_DIGITS ? end - LIMB_DIGITS : 0;
+        Limb v{};
+        for (auto k = begin; k < end; ++k)
+            v = v * 10 + (s[k] - '0');
+        StoreLimb(p, v);
+        end = begin;
     }
-    if (y.sign)
-        return x % Abs(y);
-    if (x.value == y.value || y.value == "1")
+    return p;
+}
+// Reads the header of an integer in [p, last), checks its limbs and returns the first one
+static const unsigned char* ReadInteger(const unsigned char* p, const unsigned char* last, std::size_t& n, bool& sign)
+{
+    std::uint64_t h{};
+    for (int shift{};; shift += 7)
+    {
+        // The tenth byte holds only bit 63
+        if (p == last || shift > 63 || (shift == 63 && *p > 1))
+            CorruptBinary();
+        h |= std::uint64_t{*p & 0x7Fu} << shift;
+        if ((*p++ & 0x80) == 0)
+            break;
+    }
+    sign = (h & 1) != 0;
+    if (h >> 1 > static_cast<std::uint64_t>(last - p) / LIMB_BYTES)
+        CorruptBinary();
+    n = static_cast<std::size_t>(h >> 1);
+    // Zero has no limbs and no sign, other numbers have no leading zero limbs
+    if (n == 0 ? sign : LoadLimb(p + (n - 1) * LIMB_BYTES) == 0)
+        CorruptBinary();
+    for (std::size_t i{}; i < n; ++i)
+        if (LoadLimb(p + i * LIMB_BYTES) >= LIMB_BASE)
+            CorruptBinary();
+    return p;
+}
+// The limbs of a view, already checked by ReadInteger
+static void LoadLimbs(std::vector<Limb>& l, const unsigned char* p, const std::size_t n)
+{
+    l.resize(n);
+    for (std::size_t i{}; i < n; ++i, p += LIMB_BYTES)
+        l[i] = LoadLimb(p);
+}
+static inline int CompareLimbs(const unsigned char* a, const std::size_t n, const unsigned char* b, const std::size_t m)
+{
+    if (n != m)
+        return n < m ? -1 : 1;
+    for (auto i = n; i-- > 0;)
+    {
+        auto x = LoadLimb(a + i * LIMB_BYTES), y = LoadLimb(b + i * LIMB_BYTES);
+        if (x != y)
+            return x < y ? -1 : 1;
+    }
+    return 0;
+}
+
+std::size_t BinarySize(const BigInt& x)
+{
+    return 1 + IntegerBinarySize(x);
+}
+char* WriteBinary(char* out, const BigInt& x)
+{
+    auto p = reinterpret_cast<unsigned char*>(out);
+    *p++ = BINARY_VERSION;
+    return reinterpret_cast<char*>(WriteInteger(p, x));
+}
+std::ostream& WriteBinary(std::ostream& out, const BigInt& x)
+{
+    std::string buffer(BinarySize(x), '\0');
+    WriteBinary(&buffer[0], x);
+    return out.write(buffer.data(), buffer.size());
+}
+// Reads one integer body from in, appending its bytes to buffer
+static std::uint64_t ReadVarint(std::istream& in, std::string& buffer)
+{
+    std::uint64_t h{};
+    for (int shift{};; shift += 7)
+    {
+        auto c = in.get();
+        if (c == std::char_traits<char>::eof() || shift > 63 || (shift == 63 && c > 1))
+            CorruptBinary();
+        buffer.push_back(static_cast<char>(c));
+        h |= std::uint64_t{c & 0x7Fu} << shift;
+        if ((c & 0x80) == 0)
+            return h;
+    }
+}
+static void ReadIntegerBytes(std::istream& in, std::string& buffer)
+{
+    auto h = ReadVarint(in, buffer);
+    if (h >> 1 > static_cast<std::uint64_t>(std::numeric_limits<std::streamsize>::max()) / LIMB_BYTES)
+        CorruptBinary();
+    auto bytes = static_cast<std::streamsize>((h >> 1) * LIMB_BYTES);
+    auto begin = buffer.size();
+    buffer.resize(begin + bytes);
+    if (!in.read(&buffer[begin], bytes))
+        CorruptBinary();
+}
+static inline void ReadVersion(std::istream& in, std::string& buffer)
+{
+    auto c = in.get();
+    if (c == std::char_traits<char>::eof())
+        CorruptBinary();
+    if (c != BINARY_VERSION)
+    {
+        throw std::invalid_argument("ERROR: Unsupported binary format version");
+    }
+    buffer.push_back(static_cast<char>(c));
+}
+BigInt ReadBigInt(std::istream& in)
+{
+    std::string buffer;
+    ReadVersion(in, buffer);
+    ReadIntegerBytes(in, buffer);
+    return BigIntView(buffer.data(), buffer.data() + buffer.size());
+}
+
+BigIntView::BigIntView(const char* first, const char* last)
+{
+    auto p = reinterpret_cast<const unsigned char*>(first);
+    if (p == reinterpret_cast<const unsigned char*>(last))
+        CorruptBinary();
+    if (*p != BINARY_VERSION)
+    {
+        throw std::invalid_argument("ERROR: Unsupported binary format version");
+    }
+    limbs = ReadInteger(p + 1, reinterpret_cast<const unsigned char*>(last), size, sign);
+}
+bool BigIntView::get_sign() const {return sign;}
+const char* BigIntView::get_end() const
+{
+    return reinterpret_cast<const char*>(limbs + size * LIMB_BYTES);
+}
+
+BigInt::BigInt(const BigIntView& x)
+{
+    std::vector<Limb> l;
+    LoadLimbs(l, x.limbs, x.size);
+    FromLimbs(value, l.data(), l.size());
+    sign = x.sign;
+}
+
+BigInt operator+(const BigIntView& x, const BigIntView& y)
+{
+    const BigIntView* a = &x;
+    const BigIntView* b = &y;
+    if (CompareLimbs(x.limbs, x.size, y.limbs, y.size) < 0)
+        std::swap(a, b);
+    std::vector<Limb> r, t;
+    LoadLimbs(r, a->limbs, a->size);
+    LoadLimbs(t, b->limbs, b->size);
+    if (a->sign == b->sign)
+    {
+        r.push_back(0);
+        AddLimbs(r.data(), r.size(), t.data(), t.size());
+    }
+    else
+        SubtractLimbs(r.data(), r.size(), t.data(), t.size());
+    BigInt z;
+    FromLimbs(z.value, r.data(), r.size());
+    z.sign = a->sign && z.value != "0";
+    return z;
+}
+BigInt operator-(const BigIntView& x, const BigIntView& y)
+{
+    BigIntView t{y};
+    t.sign = !y.sign && y.size != 0;
+    return x + t;
+}
+BigInt operator*(const BigIntView& x, const BigIntView& y)
+{
+    if (x.size == 0 || y.size == 0)
         return ZERO;
-    if (x < y)
-        return x;
-    BigInt rem;
-    rem.value = std::string(x.value.cbegin(), x.value.cbegin() + y.value.length());
-    if (rem < y)
-        rem.value.push_back(x.value[y.value.length()]);
-    auto i = rem.value.length();
-    while (rem >= y)
-        rem -= y;
-    for (; i < x.value.length(); ++i)
-    {
-        if (rem.value == "0")
-            rem.value.clear();
-        rem.value.push_back(x.value[i]);
-        while (rem >= y)
-            rem -= y;
+    std::vector<Limb> a, b;
+    LoadLimbs(a, x.limbs, x.size);
+    LoadLimbs(b, y.limbs, y.size);
+    std::vector<Limb> r(a.size() + b.size());
+    MultiplyLimbs(a.data(), a.size(), b.data(), b.size(), r.data());
+    BigInt z;
+    FromLimbs(z.value, r.data(), r.size());
+    z.sign = x.sign != y.sign;
+    return z;
+}
+
+bool operator>=(const BigIntView& x, const BigIntView& y)
+{
+    return !(x < y);
+}
+bool operator<=(const BigIntView& x, const BigIntView& y)
+{
+    return !(y < x);
+}
+bool operator==(const BigIntView& x, const BigIntView& y)
+{
+    return x.sign == y.sign && CompareLimbs(x.limbs, x.size, y.limbs, y.size) == 0;
+}
+bool operator!=(const BigIntView& x, const BigIntView& y)
+{
+    return !(x == y);
+}
+bool operator>(const BigIntView& x, const BigIntView& y)
+{
+    return y < x;
+}
+bool operator<(const BigIntView& x, const BigIntView& y)
+{
+    if (x.sign != y.sign)
+        return x.sign;
+    auto c = CompareLimbs(x.limbs, x.size, y.limbs, y.size);
+    return x.sign ? c > 0 : c < 0;
+}
+
+bool EvenQ(const BigIntView& x)
+{
+    return x.size == 0 || LoadLimb(x.limbs) % 2 == 0;
+}
+bool OddQ(const BigIntView& x)
+{
+    return !EvenQ(x);
+}
+std::size_t IntegerLength(const BigIntView& x)
+{
+    if (x.size == 0)
+        return 1;
+    return (x.size - 1) * LIMB_DIGITS + std::to_string(LoadLimb(x.limbs + (x.size - 1) * LIMB_BYTES)).length();
+}
+
+// Out-of-core integers. A file holds one integer in the binary format; results are written
+// with the varint of their header padded to 10 bytes, so that it can be filled in once the
+// limb count is known.
+static constexpr std::size_t FILE_HEADER = 11;
+static constexpr std::size_t MIN_FILE_MEMORY = std::size_t{1} << 20;
+// Smaller factors are multiplied in memory, block by block of the other one
+static constexpr std::size_t TRANSFORM_THRESHOLD = 4096; // limbs
+
+static std::atomic<std::size_t> file_memory{std::size_t{256} << 20};
+static std::mutex scratch_mutex;
+static std::string scratch_directory;
+
+void SetScratchDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(scratch_mutex);
+    scratch_directory = directory;
+}
+std::string ScratchDirectory()
+{
+    {
+        std::lock_guard<std::mutex> lock(scratch_mutex);
+        if (!scratch_directory.empty())
+            return scratch_directory;
     }
-    return rem;
+    return std::filesystem::temp_directory_path().string();
 }
-BigInt operator^(const BigInt& x, const int y)
+void SetFileMemory(const std::size_t bytes)
 {
-    if (y < 0)
+    file_memory = std::max(bytes, MIN_FILE_MEMORY);
+}
+std::size_t FileMemory()
+{
+    return file_memory;
+}
+// 8-byte words that each of k buffers may hold, no more than n
+static inline std::size_t BlockWords(const std::size_t k, const std::uint64_t n)
+{
+    return static_cast<std::size_t>(std::max<std::uint64_t>(std::min<std::uint64_t>(FileMemory() / (8 * k), n), 1));
+}
+
+static inline void FileError(const std::string& path)
+{
+    throw std::runtime_error("ERROR: Cannot access file " + path);
+}
+
+// A file in the scratch directory, removed unless released
+class ScratchFile
+{
+private:
+    std::string path;
+public:
+    ScratchFile()
     {
-        throw std::domain_error("Power is a negative integer");
+        static const auto tag = std::random_device{}();
+        static std::atomic<unsigned long long> count{};
+        char name[64];
+        std::snprintf(name, sizeof name, "bigint-%08x-%llu.tmp", tag, count++);
+        path = (std::filesystem::path(ScratchDirectory()) / name).string();
     }
-    if (x.value == "0" && y == 0)
+    ScratchFile(const ScratchFile&)=delete;
+    ScratchFile& operator=(const ScratchFile&)=delete;
+    ~ScratchFile()
     {
-        throw std::domain_error("Indeterminate expression 0^0 encountered");
+        std::error_code e;
+        if (!path.empty())
+            std::filesystem::remove(path, e);
     }
-    if (x.value == "0")
-        return x;
-    if (y == 0)
-        return ONE;
-    if (x.sign)
+    const std::string& Path() const {return path;}
+    std::string Release() {return std::exchange(path, std::string{});}
+};
+
+// Reads the limbs of an integer file in blocks, checking that they are valid
+class LimbReader
+{
+private:
+    std::ifstream in;
+    std::string path;
+    std::uint64_t offset, size;
+    std::vector<unsigned char> bytes;
+public:
+    LimbReader(const std::string& path, const std::uint64_t offset, const std::uint64_t size)
+        : path(path), offset(offset), size(size)
     {
-        if (y % 2 == 0)
-            return Abs(x) ^ y;
-        else
+        if (size == 0)
+            return;
+        in.open(path, std::ios::binary);
+        if (!in)
+            FileError(path);
+    }
+    // l[0..n) = limbs [first, first + n), zero above the top limb
+    void Read(const std::uint64_t first, Limb* l, const std::size_t n)
+    {
+        auto k = first < size ? static_cast<std::size_t>(std::min<std::uint64_t>(n, size - first)) : 0;
+        if (k != 0)
         {
-            BigInt z = Abs(x) ^ y;
-            z.sign = true;
-            return z;
+            bytes.resize(k * LIMB_BYTES);
+            in.seekg(static_cast<std::streamoff>(offset + first * LIMB_BYTES));
+            if (!in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+                FileError(path);
         }
+        for (std::size_t i{}; i < k; ++i)
+            if ((l[i] = LoadLimb(&bytes[i * LIMB_BYTES])) >= LIMB_BASE)
+                CorruptBinary();
+        std::fill(l + k, l + n, 0);
     }
-    if (y == 1)
+};
+
+// Writes the limbs of a result to a scratch file, from the lowest one up
+class LimbWriter
+{
+private:
+    ScratchFile file;
+    std::ofstream out;
+    std::uint64_t count{}, size{};
+    std::vector<unsigned char> bytes;
+public:
+    LimbWriter() : out(file.Path(), std::ios::binary)
+    {
+        char header[FILE_HEADER]{static_cast<char>(BINARY_VERSION)};
+        if (!out.write(header, sizeof header))
+            FileError(file.Path());
+    }
+    void Write(const Limb* l, const std::size_t n)
+    {
+        bytes.resize(n * LIMB_BYTES);
+        for (std::size_t i{}; i < n; ++i)
+        {
+            StoreLimb(&bytes[i * LIMB_BYTES], l[i]);
+            if (l[i] != 0)
+                size = count + i + 1;
+        }
+        count += n;
+        if (!out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+            FileError(file.Path());
+    }
+    // Fills in the header, drops the leading zero limbs and returns the limb count
+    std::uint64_t Finish(const bool sign)
+    {
+        auto h = size << 1 | (sign && size != 0 ? 1 : 0);
+        char header[FILE_HEADER - 1];
+        for (std::size_t i{}; i < sizeof header; ++i, h >>= 7)
+            header[i] = static_cast<char>((h & 0x7F) | (i + 1 < sizeof header ? 0x80 : 0));
+        out.seekp(1);
+        out.write(header, sizeof header);
+        out.close();
+        if (!out)
+            FileError(file.Path());
+        std::filesystem::resize_file(file.Path(), FILE_HEADER + size * LIMB_BYTES);
+        return size;
+    }
+    std::string Release() {return file.Release();}
+};
+
+BigIntFile::BigIntFile(std::string path, const std::uint64_t size, const bool sign)
+    : path(std::move(path)), offset(FILE_HEADER), size(size), sign(sign), temporary(true) {}
+BigIntFile::BigIntFile(const BigInt& x)
+{
+    auto n = LimbCount(x.get_value());
+    if (n == 0)
+        return;
+    ScratchFile file;
+    std::ofstream out(file.Path(), std::ios::binary);
+    WriteBinary(out, x);
+    out.close();
+    if (!out)
+        FileError(file.Path());
+    path = file.Release();
+    offset = 1 + VarintSize(std::uint64_t{n} << 1);
+    size = n;
+    sign = x.get_sign();
+    temporary = true;
+}
+BigIntFile BigIntFile::Open(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        FileError(path);
+    std::string buffer;
+    ReadVersion(in, buffer);
+    auto h = ReadVarint(in, buffer);
+    in.close();
+    BigIntFile x;
+    x.path = path;
+    x.offset = buffer.size();
+    x.size = h >> 1;
+    x.sign = (h & 1) != 0;
+    if (x.size > (std::filesystem::file_size(path) - x.offset) / LIMB_BYTES)
+        CorruptBinary();
+    if (x.size == 0)
+    {
+        if (x.sign)
+            CorruptBinary();
         return x;
-    BigInt z(x);
-    for (int i{1}; i < y; ++i)
-        z *= x;
-    return z;
+    }
+    Limb top;
+    LimbReader(path, x.offset, x.size).Read(x.size - 1, &top, 1);
+    if (top == 0)
+        CorruptBinary();
+    return x;
+}
+BigIntFile::BigIntFile(BigIntFile&& x) noexcept
+    : path(std::move(x.path)), offset(x.offset), size(x.size), sign(x.sign),
+      temporary(std::exchange(x.temporary, false))
+{
+    x.path.clear();
+    x.size = 0;
+    x.sign = false;
 }
+BigIntFile& BigIntFile::operator=(BigIntFile&& x) noexcept
+{
+    BigIntFile t(std::move(x));
+    std::swap(path, t.path);
+    std::swap(offset, t.offset);
+    std::swap(size, t.size);
+    std::swap(sign, t.sign);
+    std::swap(temporary, t.temporary);
+    return *this;
+}
+BigIntFile::~BigIntFile()
+{
+    std::error_code e;
+    if (temporary)
+        std::filesystem::remove(path, e);
+}
+bool BigIntFile::get_sign() const {return sign;}
+const std::string& BigIntFile::get_path() const {return path;}
 
-bool operator>=(const BigInt& x, const BigInt& y)
+BigInt::BigInt(const BigIntFile& x)
 {
-    if (!x.sign && y.sign)
-        return true;
-    if (x.sign && !y.sign)
-        return false;
-    // x and y are negative
-    if (x.sign && y.sign)
+    std::vector<Limb> l(static_cast<std::size_t>(x.size));
+    LimbReader(x.path, x.offset, x.size).Read(0, l.data(), l.size());
+    FromLimbs(value, l.data(), l.size());
+    sign = x.sign;
+}
+
+std::ostream& operator<<(std::ostream& out, const BigIntFile& x)
+{
+    if (x.size == 0)
+        return out << '0';
+    LimbReader in(x.path, x.offset, x.size);
+    Limb top;
+    in.Read(x.size - 1, &top, 1);
+    if (x.sign)
+        out << '-';
+    out << top;
+    auto block = BlockWords(2, x.size);
+    std::vector<Limb> l(block);
+    std::string s;
+    for (auto end = x.size - 1; end > 0;)
     {
-        if (x.value.length() < y.value.length())
-            return true;
-        if (x.value.length() > y.value.length())
-            return false;
-        if (x.value.compare(y.value) <= 0)
-            return true;
-        return false;
+        auto k = static_cast<std::size_t>(std::min<std::uint64_t>(block, end));
+        end -= k;
+        in.Read(end, l.data(), k);
+        s.resize(k * LIMB_DIGITS);
+        for (std::size_t i{}; i < k; ++i)
+        {
+            auto v = l[k - 1 - i];
+            for (auto p = (i + 1) * LIMB_DIGITS; p > i * LIMB_DIGITS; v /= 10)
+                s[--p] = static_cast<char>(v % 10 + '0');
+        }
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
     }
-    // x and y are positive
-    if (x.value.length() > y.value.length())
-        return true;
-    if (x.value.length() < y.value.length())
-        return false;
-    if (x.value.compare(y.value) >= 0)
-        return true;
-    return false;
+    return out;
 }
-bool operator<=(const BigInt& x, const BigInt& y)
+
+static int CompareFiles(LimbReader& a, const std::uint64_t n, LimbReader& b, const std::uint64_t m)
 {
-    if (!x.sign && y.sign)
-        return false;
-    if (x.sign && !y.sign)
-        return true;
-    // x and y are negative
-    if (x.sign && y.sign)
+    if (n != m)
+        return n < m ? -1 : 1;
+    auto block = BlockWords(2, n);
+    std::vector<Limb> x(block), y(block);
+    for (auto end = n; end > 0;)
     {
-        if (x.value.length() > y.value.length())
-            return true;
-        if (x.value.length() < y.value.length())
-            return false;
-        if (x.value.compare(y.value) >= 0)
-            return true;
-        return false;
+        auto k = static_cast<std::size_t>(std::min<std::uint64_t>(block, end));
+        end -= k;
+        a.Read(end, x.data(), k);
+        b.Read(end, y.data(), k);
+        for (auto i = k; i-- > 0;)
+            if (x[i] != y[i])
+                return x[i] < y[i] ? -1 : 1;
     }
-    // x and y are positive
-    if (x.value.length() < y.value.length())
-        return true;
-    if (x.value.length() > y.value.length())
-        return false;
-    if (x.value.compare(y.value) <= 0)
-        return true;
-    return false;
+    return 0;
 }
-bool operator==(const BigInt& x, const BigInt& y)
+
+BigIntFile operator+(const BigIntFile& x, const BigIntFile& y)
 {
-    if (x.sign == y.sign && x.value == y.value)
-        return true;
-    return false;
+    LimbReader rx(x.path, x.offset, x.size), ry(y.path, y.offset, y.size);
+    const BigIntFile* a = &x;
+    const BigIntFile* b = &y;
+    LimbReader* ra = &rx;
+    LimbReader* rb = &ry;
+    auto c = CompareFiles(rx, x.size, ry, y.size);
+    if (c < 0)
+    {
+        std::swap(a, b);
+        std::swap(ra, rb);
+    }
+    auto add = a->sign == b->sign;
+    if (!add && c == 0)
+        return BigIntFile();
+    auto block = BlockWords(2, a->size);
+    std::vector<Limb> u(block), v(block);
+    LimbWriter w;
+    Limb carry{};
+    for (std::uint64_t i{}; i < a->size; i += block)
+    {
+        SafePoint();
+        auto k = static_cast<std::size_t>(std::min<std::uint64_t>(block, a->size - i));
+        ra->Read(i, u.data(), k);
+        rb->Read(i, v.data(), k);
+        if (add)
+            for (std::size_t j{}; j < k; ++j)
+            {
+                Limb d = u[j] + v[j] + carry;
+                carry = d >= LIMB_BASE ? 1 : 0;
+                u[j] = d - carry * LIMB_BASE;
+            }
+        else
+            for (std::size_t j{}; j < k; ++j)
+            {
+                Limb s = v[j] + carry;
+                carry = u[j] < s ? 1 : 0;
+                u[j] = u[j] + carry * LIMB_BASE - s;
+            }
+        w.Write(u.data(), k);
+    }
+    if (carry != 0)
+        w.Write(&carry, 1);
+    auto n = w.Finish(a->sign);
+    if (n == 0)
+        return BigIntFile();
+    return BigIntFile(w.Release(), n, a->sign);
 }
-bool operator!=(const BigInt& x, const BigInt& y)
+BigIntFile operator-(const BigIntFile& x, const BigIntFile& y)
 {
-    return !(x == y);
+    // Refers to the file of y without owning it
+    BigIntFile t;
+    t.path = y.path;
+    t.offset = y.offset;
+    t.size = y.size;
+    t.sign = !y.sign && y.size != 0;
+    return x + t;
 }
-bool operator>(const BigInt& x, const BigInt& y)
+
+// Products with a small factor: the long one is multiplied block by block, carrying the top
+// m limbs of each partial product into the next
+static void MultiplyBlocks(LimbReader& a, const std::uint64_t n, LimbReader& b, const std::size_t m, LimbWriter& w)
 {
-    if (!x.sign && y.sign)
-        return true;
-    if (x.sign && !y.sign)
-        return false;
-    // x and y are negative
-    if (x.sign && y.sign)
+    std::vector<Limb> v(m);
+    b.Read(0, v.data(), m);
+    auto block = std::max(BlockWords(2, n), m);
+    std::vector<Limb> u(block), t(block + m), carry(m);
+    for (std::uint64_t i{}; i < n; i += block)
     {
-        if (x.value.length() < y.value.length())
-            return true;
-        if (x.value.length() > y.value.length())
-            return false;
-        if (x.value.compare(y.value) < 0)
-            return true;
-        return false;
+        SafePoint();
+        auto k = static_cast<std::size_t>(std::min<std::uint64_t>(block, n - i));
+        a.Read(i, u.data(), k);
+        MultiplyLimbs(u.data(), k, v.data(), m, t.data());
+        AddLimbs(t.data(), k + m, carry.data(), m);
+        w.Write(t.data(), k);
+        std::copy(t.begin() + k, t.begin() + k + m, carry.begin());
     }
-    // x and y are positive
-    if (x.value.length() > y.value.length())
-        return true;
-    if (x.value.length() < y.value.length())
-        return false;
-    if (x.value.compare(y.value) > 0)
-        return true;
-    return false;
+    w.Write(carry.data(), m);
 }
-bool operator<(const BigInt& x, const BigInt& y)
+
+// Products of large factors are convolutions of their limbs, computed by number theoretic
+// transforms modulo two primes below 2^63 and recombined by the Chinese remainder theorem
+struct Wide
 {
-    if (!x.sign && y.sign)
-        return false;
-    if (x.sign && !y.sign)
-        return true;
-    // x and y are negative
-    if (x.sign && y.sign)
+    std::uint64_t hi, lo;
+};
+static inline Wide MultiplyWide(const std::uint64_t a, const std::uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 Word128;
+    auto t = static_cast<Word128>(a) * b;
+    return {static_cast<std::uint64_t>(t >> 64), static_cast<std::uint64_t>(t)};
+#else
+    auto a0 = a & 0xFFFFFFFF, a1 = a >> 32, b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+    auto p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    auto mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    return {p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32), mid << 32 | (p00 & 0xFFFFFFFF)};
+#endif
+}
+// Returns x mod 10^9 and sets x to x / 10^9
+static inline Limb DivideWide(Wide& x)
+{
+    std::uint64_t r{};
+    std::uint64_t parts[4]{x.hi >> 32, x.hi & 0xFFFFFFFF, x.lo >> 32, x.lo & 0xFFFFFFFF};
+    for (auto& p : parts)
     {
-        if (x.value.length() > y.value.length())
-            return true;
-        if (x.value.length() < y.value.length())
-            return false;
-        if (x.value.compare(y.value) > 0)
-            return true;
-        return false;
+        auto t = r << 32 | p;
+        p = t / LIMB_BASE;
+        r = t % LIMB_BASE;
     }
-    // x and y are positive
-    if (x.value.length() < y.value.length())
-        return true;
-    if (x.value.length() > y.value.length())
-        return false;
-    if (x.value.compare(y.value) < 0)
-        return true;
-    return false;
+    x = {parts[0] << 32 | parts[1], parts[2] << 32 | parts[3]};
+    return static_cast<Limb>(r);
 }
 
-BigInt Abs(const BigInt& x)
+// Arithmetic modulo an odd p < 2^63, products taken in Montgomery form with R = 2^64
+struct Modulus
+{
+    std::uint64_t p, inverse, r2, one, root;
+    Modulus(const std::uint64_t p, const std::uint64_t g) : p(p), inverse(p)
+    {
+        // Newton's iteration doubles the correct low bits of p^-1 mod 2^64
+        for (int i{}; i < 5; ++i)
+            inverse *= 2 - p * inverse;
+        one = (0 - p) % p;
+        r2 = one;
+        for (int i{}; i < 64; ++i)
+            r2 = Add(r2, r2);
+        root = Montgomery(g);
+    }
+    std::uint64_t Add(const std::uint64_t a, const std::uint64_t b) const
+    {
+        auto s = a + b;
+        return s >= p ? s - p : s;
+    }
+    std::uint64_t Subtract(const std::uint64_t a, const std::uint64_t b) const
+    {
+        return a >= b ? a - b : a + p - b;
+    }
+    // a * b / R mod p
+    std::uint64_t Multiply(const std::uint64_t a, const std::uint64_t b) const
+    {
+        auto t = MultiplyWide(a, b);
+        auto h = MultiplyWide(t.lo * inverse, p).hi;
+        return t.hi >= h ? t.hi - h : t.hi + p - h;
+    }
+    std::uint64_t Montgomery(const std::uint64_t a) const
+    {
+        return Multiply(a, r2);
+    }
+    std::uint64_t Power(std::uint64_t a, std::uint64_t e) const
+    {
+        auto r = one;
+        for (; e != 0; e >>= 1, a = Multiply(a, a))
+            if (e & 1)
+                r = Multiply(r, a);
+        return r;
+    }
+    // Primitive n-th root of unity for a power of two n, or its inverse
+    std::uint64_t Root(const std::uint64_t n, const bool inverse) const
+    {
+        auto w = Power(root, (p - 1) / n);
+        return inverse ? Power(w, n - 1) : w;
+    }
+};
+static const Modulus TRANSFORM_PRIMES[2]{{4179340454199820289, 3}, {6269010681299730433, 5}};
+
+// Roots of unity for transforms of length n: w[h + j] = w_2h^j
+static std::vector<std::uint64_t> TransformRoots(const Modulus& q, const std::size_t n, const bool inverse)
 {
-    BigInt y{x};
-    y.sign = false;
-    return y;
+    std::vector<std::uint64_t> w(n);
+    for (std::size_t h{1}; h < n; h *= 2)
+    {
+        auto r = q.Root(2 * h, inverse);
+        w[h] = q.one;
+        for (std::size_t j{1}; j < h; ++j)
+            w[h + j] = q.Multiply(w[h + j - 1], r);
+    }
+    return w;
 }
-BigInt Factorial(const int n)
+// Transforms a[0..n) in place, in natural order. The roots are in Montgomery form, so
+// plain residues stay plain.
+static void Transform(std::uint64_t* a, const std::size_t n, const Modulus& q, const std::vector<std::uint64_t>& w)
 {
-    if (n < 0)
+    for (std::size_t i{1}, j{}; i < n; ++i)
     {
-        throw std::domain_error("Factorial of a negative integer");
+        auto bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
     }
-    BigInt x{ONE};
-    int c{0};
-    for (int i{2}; i <= n; ++i)
+    for (std::size_t h{1}; h < n; h *= 2)
+        for (std::size_t i{}; i < n; i += 2 * h)
+            for (std::size_t j{}; j < h; ++j)
+            {
+                auto u = a[i + j], v = q.Multiply(a[i + j + h], w[h + j]);
+                a[i + j] = q.Add(u, v);
+                a[i + j + h] = q.Subtract(u, v);
+            }
+}
+
+// Residues of a transform, held in memory or in a scratch file
+class WordStore
+{
+private:
+    std::vector<std::uint64_t> memory;
+    std::unique_ptr<ScratchFile> file;
+    std::fstream stream;
+public:
+    WordStore(const std::uint64_t n, const bool in_memory)
     {
-        for (std::size_t j{}; j < x.value.length(); ++j)
+        if (in_memory)
         {
-            int p = (x.value[j] - '0') * i + c;
-            x.value[j] = p % 10 + '0';
-            c = p / 10;
+            memory.resize(static_cast<std::size_t>(n));
+            return;
         }
-        while (c > 0)
+        file = std::make_unique<ScratchFile>();
+        if (!std::ofstream(file->Path(), std::ios::binary))
+            FileError(file->Path());
+        std::filesystem::resize_file(file->Path(), n * sizeof(std::uint64_t));
+        stream.open(file->Path(), std::ios::in | std::ios::out | std::ios::binary);
+        if (!stream)
+            FileError(file->Path());
+    }
+    std::uint64_t* Data() {return file ? nullptr : memory.data();}
+    void Read(const std::uint64_t first, std::uint64_t* w, const std::size_t n)
+    {
+        if (!file)
         {
-            x.value.push_back(c % 10 + '0');
-            c /= 10;
+            std::copy_n(memory.data() + first, n, w);
+            return;
         }
+        stream.seekg(static_cast<std::streamoff>(first * sizeof *w));
+        if (!stream.read(reinterpret_cast<char*>(w), static_cast<std::streamsize>(n * sizeof *w)))
+            FileError(file->Path());
     }
-    std::reverse(x.value.begin(), x.value.end());
-    return x;
-}
-BigInt GCD(const BigInt& x, const BigInt& y)
-{
-    if(x.value == "0" && y.value == "0")
-        return ZERO;
-    if (x.sign && !y.sign)
-        return GCD(Abs(x), y);
-    if (!x.sign && y.sign)
-        return GCD(x, Abs(y));
-    if (x.sign && y.sign)
-        return GCD(Abs(x), Abs(y));
-    if (y.value == "0")
-        return x;
-    else
-        return GCD(y, x % y);
-}
-BigInt LCM(const BigInt& x, const BigInt& y)
+    void Write(const std::uint64_t first, const std::uint64_t* w, const std::size_t n)
+    {
+        if (!file)
+        {
+            std::copy_n(w, n, memory.data() + first);
+            return;
+        }
+        stream.seekp(static_cast<std::streamoff>(first * sizeof *w));
+        if (!stream.write(reinterpret_cast<const char*>(w), static_cast<std::streamsize>(n * sizeof *w)))
+            FileError(file->Path());
+    }
+};
+
+// Transforms of length r down the c columns of the r x c matrix in s, read in stripes of
+// columns. Element (i, j) is multiplied by root^(i j) after the transform, or before it
+// when inverse.
+static void TransformColumns(WordStore& s, const std::size_t r, const std::size_t c, const Modulus& q,
+    const std::uint64_t root, const bool inverse, const std::size_t words)
 {
-    if (x.value == "0" || y.value == "0")
-        return ZERO;
-    if (x.sign && !y.sign)
-        return GCD(Abs(x), y);
-    if (!x.sign && y.sign)
-        return GCD(x, Abs(y));
-    if (x.sign && y.sign)
-        return GCD(Abs(x), Abs(y));
-    return Abs(y) * (Abs(x) / GCD(x, y));
+    auto w = TransformRoots(q, r, inverse);
+    auto width = std::min(c, std::max<std::size_t>(words / r, 1));
+    std::vector<std::uint64_t> stripe(r * width);
+    for (std::size_t first{}; first < c; first += width)
+    {
+        SafePoint();
+        auto k = std::min(width, c - first);
+        for (std::size_t i{}; i < r; ++i)
+            s.Read(std::uint64_t{i} * c + first, &stripe[i * k], k);
+        auto step = [&](const std::size_t begin, const std::size_t end)
+        {
+            std::vector<std::uint64_t> a(r);
+            for (auto j = begin; j < end; ++j)
+            {
+                for (std::size_t i{}; i < r; ++i)
+                    a[i] = stripe[i * k + j];
+                if (!inverse)
+                    Transform(a.data(), r, q, w);
+                auto t = q.one, u = q.Power(root, first + j);
+                for (std::size_t i{}; i < r; ++i, t = q.Multiply(t, u))
+                    a[i] = q.Multiply(a[i], t);
+                if (inverse)
+                    Transform(a.data(), r, q, w);
+                for (std::size_t i{}; i < r; ++i)
+                    stripe[i * k + j] = a[i];
+            }
+        };
+        if (ParallelQ(r * k * LIMB_DIGITS))
+            ParallelFor(k, step);
+        else
+            step(0, k);
+        for (std::size_t i{}; i < r; ++i)
+            s.Write(std::uint64_t{i} * c + first, &stripe[i * k], k);
+    }
 }
-BigInt ISqrt(const BigInt& x)
+// Transforms of length c along the r rows of the matrix in s, read in bands of rows
+static void TransformRows(WordStore& s, const std::size_t r, const std::size_t c, const Modulus& q,
+    const bool inverse, const std::size_t words)
 {
-    if (x.sign)
+    auto w = TransformRoots(q, c, inverse);
+    auto height = std::min(r, std::max<std::size_t>(words / c, 1));
+    std::vector<std::uint64_t> band(height * c);
+    for (std::size_t first{}; first < r; first += height)
     {
-        throw std::domain_error("Integer square root of a negative integer");
+        SafePoint();
+        auto k = std::min(height, r - first);
+        s.Read(std::uint64_t{first} * c, band.data(), k * c);
+        auto step = [&](const std::size_t begin, const std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                Transform(&band[i * c], c, q, w);
+        };
+        if (ParallelQ(k * c * LIMB_DIGITS))
+            ParallelFor(k, step);
+        else
+            step(0, k);
+        s.Write(std::uint64_t{first} * c, band.data(), k * c);
     }
-    if (x.value == "0" || x.value == "1")
-        return x;
-    auto x0 = x / TWO;
-    auto x1 = (x0 + x / x0) / TWO;
-    while (!(x1 >= x0))
+}
+// Transforms the n words of s. Words on file are transformed in four steps over an r x c
+// matrix, so that each pass reads the file in blocks: X[k1 + r k2] ends up at (k1, k2).
+static void Transform(WordStore& s, const std::uint64_t n, const Modulus& q, const bool inverse)
+{
+    if (auto a = s.Data())
     {
-        x0 = x1;
-        x1 = (x0 + x / x0) / TWO;
+        Transform(a, static_cast<std::size_t>(n), q, TransformRoots(q, static_cast<std::size_t>(n), inverse));
+        return;
     }
-    return x0;
+    int bits{};
+    while (std::uint64_t{1} << bits < n)
+        ++bits;
+    auto r = std::size_t{1} << bits / 2, c = static_cast<std::size_t>(n / r);
+    auto words = BlockWords(2, n);
+    auto root = q.Root(n, inverse);
+    if (inverse)
+        TransformRows(s, r, c, q, true, words);
+    TransformColumns(s, r, c, q, root, inverse, words);
+    if (!inverse)
+        TransformRows(s, r, c, q, false, words);
 }
-BigInt Fibonacci(const int n)
+
+static void MultiplyTransform(LimbReader& a, const std::uint64_t n, LimbReader& b, const std::uint64_t m,
+    const bool square, LimbWriter& w)
 {
-    if (n < 0)
+    std::uint64_t size{1};
+    while (size < n + m)
+        size *= 2;
+    // The residues of the first prime are kept while those of the second are computed
+    auto in_memory = size * 4 * sizeof(std::uint64_t) <= FileMemory();
+    auto block = BlockWords(8, size);
+    std::vector<std::uint64_t> u(block), v(block);
+    std::vector<Limb> l(block);
+    auto load = [&](LimbReader& x, const std::uint64_t k)
     {
-        throw std::domain_error("Fibonacci of a negative integer");
+        auto s = std::make_unique<WordStore>(size, in_memory);
+        for (std::uint64_t i{}; i < k; i += block)
+        {
+            auto c = static_cast<std::size_t>(std::min<std::uint64_t>(block, k - i));
+            x.Read(i, l.data(), c);
+            std::copy_n(l.begin(), c, u.begin());
+            s->Write(i, u.data(), c);
+        }
+        return s;
+    };
+    std::unique_ptr<WordStore> residues[2];
+    for (int p{}; p < 2; ++p)
+    {
+        const auto& q = TRANSFORM_PRIMES[p];
+        auto x = load(a, n);
+        Transform(*x, size, q, false);
+        std::unique_ptr<WordStore> y;
+        if (!square)
+        {
+            y = load(b, m);
+            Transform(*y, size, q, false);
+        }
+        for (std::uint64_t i{}; i < size; i += block)
+        {
+            SafePoint();
+            auto c = static_cast<std::size_t>(std::min<std::uint64_t>(block, size - i));
+            x->Read(i, u.data(), c);
+            if (y)
+                y->Read(i, v.data(), c);
+            for (std::size_t j{}; j < c; ++j)
+                u[j] = q.Multiply(u[j], y ? v[j] : u[j]);
+            x->Write(i, u.data(), c);
+        }
+        y.reset();
+        Transform(*x, size, q, true);
+        residues[p] = std::move(x);
     }
-    if (n == 0)
-        return ZERO;
-    BigInt a, b{ONE}, c;
-    for (int i = 2; i <= n; ++i)
+    // The products and the inverse transform leave size / R times each coefficient
+    const auto& q1 = TRANSFORM_PRIMES[0];
+    const auto& q2 = TRANSFORM_PRIMES[1];
+    auto s1 = q1.Montgomery(q1.Montgomery(q1.p - (q1.p - 1) / size));
+    auto s2 = q2.Montgomery(q2.Montgomery(q2.p - (q2.p - 1) / size));
+    auto inverse = q2.Power(q2.Montgomery(q1.p), q2.p - 2);
+    Wide carry{};
+    for (std::uint64_t i{}; i < n + m; i += block)
     {
-        c = a + b;
-        a.value = b.value;
-        b.value = c.value;
+        SafePoint();
+        auto c = static_cast<std::size_t>(std::min<std::uint64_t>(block, n + m - i));
+        residues[0]->Read(i, u.data(), c);
+        residues[1]->Read(i, v.data(), c);
+        for (std::size_t j{}; j < c; ++j)
+        {
+            auto r1 = q1.Multiply(u[j], s1), r2 = q2.Multiply(v[j], s2);
+            auto z = MultiplyWide(q2.Multiply(q2.Subtract(r2, r1), inverse), q1.p);
+            z.lo += r1;
+            z.hi += z.lo < r1 ? 1 : 0;
+            z.lo += carry.lo;
+            z.hi += carry.hi + (z.lo < carry.lo ? 1 : 0);
+            l[j] = DivideWide(z);
+            carry = z;
+        }
+        w.Write(l.data(), c);
     }
-    return b;
-}
-BigInt Binomial(const int n, const int k)
-{
-    if (n < 0 || k < 0 || k > n)
-        return ZERO;
-    if (n == k || k == 0)
-        return ONE;
-    return Factorial(n) / Factorial(k) / Factorial(n - k);
-}
-bool EvenQ(const BigInt& x)
-{
-    return (x.value.back() - '0') % 2 == 0;
 }
-bool OddQ(const BigInt& x)
+
+BigIntFile operator*(const BigIntFile& x, const BigIntFile& y)
 {
-    return !EvenQ(x);
+    if (x.size == 0 || y.size == 0)
+        return BigIntFile();
+    LimbReader rx(x.path, x.offset, x.size), ry(y.path, y.offset, y.size);
+    LimbWriter w;
+    if (std::min(x.size, y.size) < TRANSFORM_THRESHOLD)
+    {
+        if (x.size < y.size)
+            MultiplyBlocks(ry, y.size, rx, static_cast<std::size_t>(x.size), w);
+        else
+            MultiplyBlocks(rx, x.size, ry, static_cast<std::size_t>(y.size), w);
+    }
+    else
+        MultiplyTransform(rx, x.size, ry, y.size, x.path == y.path && x.offset == y.offset, w);
+    auto sign = x.sign != y.sign;
+    auto n = w.Finish(sign);
+    return BigIntFile(w.Release(), n, sign);
 }
-std::size_t IntegerLength(const BigInt& x)
+
+std::size_t IntegerLength(const BigIntFile& x)
 {
-    return x.value.length();
+    if (x.size == 0)
+        return 1;
+    Limb top;
+    LimbReader(x.path, x.offset, x.size).Read(x.size - 1, &top, 1);
+    return static_cast<std::size_t>(x.size - 1) * LIMB_DIGITS + std::to_string(top).length();
 }
-std::string Approx(const BigInt& x, const std::size_t n)
+std::ostream& WriteBinary(std::ostream& out, const BigIntFile& x)
 {
-    std::string s;
-    if (x.sign)
-        s.push_back('-');
-    auto d = x.value.substr(0, std::clamp(n, 1ull, x.value.length()));
-    if (d != "0")
-        d.erase(d.find_last_not_of('0') + 1);
-    if (d.length() > 1)
-        d.insert(1, 1, '.');
-    s += d + " x 10 ^ " + std::to_string(x.value.length() - 1ull);
-    return s;
+    unsigned char header[FILE_HEADER]{BINARY_VERSION};
+    auto end = WriteVarint(header + 1, x.size << 1 | (x.sign ? 1 : 0));
+    out.write(reinterpret_cast<const char*>(header), end - header);
+    LimbReader in(x.path, x.offset, x.size);
+    auto block = BlockWords(2, x.size);
+    std::vector<Limb> l(block);
+    std::vector<unsigned char> bytes(block * LIMB_BYTES);
+    for (std::uint64_t i{}; i < x.size; i += block)
+    {
+        auto k = static_cast<std::size_t>(std::min<std::uint64_t>(block, x.size - i));
+        in.Read(i, l.data(), k);
+        for (std::size_t j{}; j < k; ++j)
+            StoreLimb(&bytes[j * LIMB_BYTES], l[j]);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(k * LIMB_BYTES));
+    }
+    return out;
 }
 
 static inline void Reduce(BigInt& x, BigInt& y)
@@ -811,16 +4499,16 @@ bool operator>(const BigFrac& x, const BigFrac& y)
     {
         if (x.denom.get_value() == y.denom.get_value())
         {
-            if (x.num.get_value() < y.num.get_value())
+            if (CompareMagnitude(x.num.get_value(), y.num.get_value()) < 0)
                 return true;
-            if (x.num.get_value() > y.num.get_value())
+            if (CompareMagnitude(x.num.get_value(), y.num.get_value()) > 0)
                 return false;
         }
         if (x.num.get_value() == y.num.get_value())
         {
-            if (x.denom.get_value() > y.denom.get_value())
+            if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) > 0)
                 return true;
-            if (x.denom.get_value() < y.denom.get_value())
+            if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) < 0)
                 return false;
         }
         if (x.num.get_value() * y.denom.get_value() < x.denom.get_value() * y.num.get_value())
@@ -830,16 +4518,16 @@ bool operator>(const BigFrac& x, const BigFrac& y)
     // x and y are positive
     if (x.denom.get_value() == y.denom.get_value())
     {
-        if (x.num.get_value() > y.num.get_value())
+        if (CompareMagnitude(x.num.get_value(), y.num.get_value()) > 0)
             return true;
-        if (x.num.get_value() < y.num.get_value())
+        if (CompareMagnitude(x.num.get_value(), y.num.get_value()) < 0)
             return false;
     }
     if (x.num.get_value() == y.num.get_value())
     {
-        if (x.denom.get_value() < y.denom.get_value())
+        if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) < 0)
             return true;
-        if (x.denom.get_value() > y.denom.get_value())
+        if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) > 0)
             return false;
     }
     if (x.num.get_value() * y.denom.get_value() > x.denom.get_value() * y.num.get_value())
@@ -857,16 +4545,16 @@ bool operator<(const BigFrac& x, const BigFrac& y)
     {
         if (x.denom.get_value() == y.denom.get_value())
         {
-            if (x.num.get_value() > y.num.get_value())
+            if (CompareMagnitude(x.num.get_value(), y.num.get_value()) > 0)
                 return true;
-            if (x.num.get_value() < y.num.get_value())
+            if (CompareMagnitude(x.num.get_value(), y.num.get_value()) < 0)
                 return false;
         }
         if (x.num.get_value() == y.num.get_value())
         {
-            if (x.denom.get_value() < y.denom.get_value())
+            if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) < 0)
                 return true;
-            if (x.denom.get_value() > y.denom.get_value())
+            if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) > 0)
                 return false;
         }
         if (x.num.get_value() * y.denom.get_value() > x.denom.get_value() * y.num.get_value())
@@ -876,16 +4564,16 @@ bool operator<(const BigFrac& x, const BigFrac& y)
     // x and y are positive
     if (x.denom.get_value() == y.denom.get_value())
     {
-        if (x.num.get_value() < y.num.get_value())
+        if (CompareMagnitude(x.num.get_value(), y.num.get_value()) < 0)
             return true;
-        if (x.num.get_value() > y.num.get_value())
+        if (CompareMagnitude(x.num.get_value(), y.num.get_value()) > 0)
             return false;
     }
     if (x.num.get_value() == y.num.get_value())
     {
-        if (x.denom.get_value() > y.denom.get_value())
+        if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) > 0)
             return true;
-        if (x.denom.get_value() < y.denom.get_value())
+        if (CompareMagnitude(x.denom.get_value(), y.denom.get_value()) < 0)
             return false;
     }
     if (x.num.get_value() * y.denom.get_value() < x.denom.get_value() * y.num.get_value())
@@ -910,10 +4598,229 @@ bool operator!=(const BigFrac& x, const BigFrac& y)
 BigFrac Abs(const BigFrac& x)
 {
     BigFrac y;
-    y.num = x.num;
+    y.num = Abs(x.num);
     y.denom = x.denom;
     return y;
 }
+
+// Remainders of at most this many digits above the target are reduced by plain division
+constexpr std::size_t QUOTIENT_LEAF = 64;
+
+// Matrix {{a, b}, {c, d}} holding the last two convergents a / c and b / d
+struct QuotientMatrix
+{
+    BigInt a{"1"}, b, c, d{"1"};
+};
+// Product of {{t, 1}, {1, 0}} over the terms t in [first, last)
+static QuotientMatrix QuotientProduct(const std::vector<BigInt>& terms, const std::size_t first, const std::size_t last)
+{
+    if (first == last)
+        return QuotientMatrix{};
+    std::vector<QuotientMatrix> v;
+    v.reserve(last - first);
+    for (auto i = first; i < last; ++i)
+        v.push_back({terms[i], ONE, ONE, ZERO});
+    auto product = [](const QuotientMatrix& x, const QuotientMatrix& y)
+    {
+        auto a = x.a * y.a, b = x.a * y.b, c = x.c * y.a, d = x.c * y.b;
+        AddMul(a, x.b, y.c);
+        AddMul(b, x.b, y.d);
+        AddMul(c, x.d, y.c);
+        AddMul(d, x.d, y.d);
+        return QuotientMatrix{std::move(a), std::move(b), std::move(c), std::move(d)};
+    };
+    auto digits = [](const QuotientMatrix& x)
+    {
+        return Digits(x.a) + Digits(x.b) + Digits(x.c) + Digits(x.d);
+    };
+    return FoldBalanced(v, product, digits);
+}
+// Appends the quotients of Euclid's algorithm on a > b >= 0 until b vanishes or has at most s
+// digits, leaving a and b at the remainders reached. As in a half-GCD, the quotients of the
+// leading digits are applied to a and b as a single matrix, and the last few of them, which
+// may differ from the true ones, are undone until a > b > 0 again
+static void EuclidQuotients(BigInt& a, BigInt& b, const std::size_t s, std::vector<BigInt>& q)
+{
+    while (b != ZERO && Digits(b) > s)
+    {
+        auto n = Digits(a), h = n - s;
+        if (h > QUOTIENT_LEAF && Digits(b) > s + h / 2)
+        {
+            // The leading h digits agree with a and b for about half of their quotients
+            auto shift = n - h;
+            BigInt x{a.get_value().substr(0, h)};
+            BigInt y{b.get_value().substr(0, Digits(b) - shift)};
+            auto mark = q.size();
+            EuclidQuotients(x, y, h - h / 2, q);
+            auto m = QuotientProduct(q, mark, q.size());
+            // (a, b) = m (u, v) and m has determinant (-1)^k
+            auto u = m.d * a, v = m.a * b;
+            SubMul(u, m.b, b);
+            SubMul(v, m.c, a);
+            if ((q.size() - mark) % 2 == 1)
+            {
+                u = -u;
+                v = -v;
+            }
+            while (q.size() > mark && !(v > ZERO && u > v))
+            {
+                auto t = q.back() * u;
+                t += v;
+                v = std::move(u);
+                u = std::move(t);
+                q.pop_back();
+            }
+            if (q.size() > mark)
+            {
+                a = std::move(u);
+                b = std::move(v);
+                continue;
+            }
+        }
+        auto t = a / b;
+        SubMul(a, t, b);
+        std::swap(a, b);
+        q.push_back(std::move(t));
+    }
+}
+// Floor of n / d for d > 0, with r set to the remainder
+static BigInt FloorDivide(const BigInt& n, const BigInt& d, BigInt& r)
+{
+    auto t = n / d;
+    r = n;
+    SubMul(r, t, d);
+    if (r.get_sign())
+    {
+        t -= ONE;
+        r += d;
+    }
+    return t;
+}
+std::vector<BigInt> ContinuedFraction(const BigFrac& x)
+{
+    BigInt r;
+    std::vector<BigInt> q{FloorDivide(x.num, x.denom, r)};
+    auto a = x.denom;
+    EuclidQuotients(a, r, 0, q);
+    return q;
+}
+BigFrac FromContinuedFraction(const std::vector<BigInt>& terms)
+{
+    if (terms.empty())
+    {
+        throw std::domain_error("Empty continued fraction");
+    }
+    auto m = QuotientProduct(terms, 0, terms.size());
+    if (m.c == ZERO)
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    // The determinant is -1 or 1, so a / c is already in lowest terms
+    BigFrac z;
+    z.num = m.c.get_sign() ? -m.a : m.a;
+    z.denom = Abs(m.c);
+    return z;
+}
+BigFrac LimitDenominator(const BigFrac& x, const BigInt& maxDen)
+{
+    if (maxDen < ONE)
+    {
+        throw std::domain_error("Denominator bound is less than 1");
+    }
+    if (x.denom <= maxDen)
+        return x;
+    BigInt b;
+    std::vector<BigInt> q{FloorDivide(x.num, x.denom, b)};
+    auto a = x.denom;
+    // Convergent denominators stay below a / b, so the quotients up to a remainder of
+    // Digits(a) - Digits(maxDen) + 1 digits are taken at once
+    auto n = Digits(a), k = Digits(maxDen);
+    if (n > k)
+        EuclidQuotients(a, b, n - k + 1, q);
+    auto m = QuotientProduct(q, 0, q.size());
+    auto p0 = std::move(m.b), q0 = std::move(m.d), p1 = std::move(m.a), q1 = std::move(m.c);
+    for (;;)
+    {
+        auto t = a / b;
+        auto q2 = q0;
+        AddMul(q2, t, q1);
+        if (q2 > maxDen)
+            break;
+        AddMul(p0, t, p1);
+        std::swap(p0, p1);
+        q0 = std::move(q1);
+        q1 = std::move(q2);
+        SubMul(a, t, b);
+        std::swap(a, b);
+    }
+    // The closer of the last convergent and the last semiconvergent within the bound
+    auto t = (maxDen - q0) / q1;
+    AddMul(p0, t, p1);
+    AddMul(q0, t, q1);
+    auto e1 = p1 * x.denom, e0 = p0 * x.denom;
+    SubMul(e1, x.num, q1);
+    SubMul(e0, x.num, q0);
+    BigFrac z;
+    if (Abs(e1) * q0 <= Abs(e0) * q1)
+    {
+        z.num = std::move(p1);
+        z.denom = std::move(q1);
+    }
+    else
+    {
+        z.num = std::move(p0);
+        z.denom = std::move(q0);
+    }
+    return z;
+}
+BigFrac Simplest(BigFrac lo, BigFrac hi)
+{
+    if (lo > hi)
+        std::swap(lo, hi);
+    if (hi < F_ZERO)
+        return -Simplest(-hi, -lo);
+    if (!(lo > F_ZERO))
+        return F_ZERO;
+    // The tails of lo and hi trade places at each level of the expansion
+    auto x = ContinuedFraction(lo), y = ContinuedFraction(hi);
+    std::vector<BigInt> terms;
+    for (std::size_t i{};; ++i)
+    {
+        const auto& l = i % 2 == 0 ? x : y;
+        const auto& h = i % 2 == 0 ? y : x;
+        if (i + 1 == l.size())
+        {
+            terms.push_back(l[i]);
+            break;
+        }
+        if (h[i] != l[i])
+        {
+            terms.push_back(l[i] + ONE);
+            break;
+        }
+        terms.push_back(l[i]);
+    }
+    return FromContinuedFraction(terms);
+}
+// Unreduced sum p / q of 1 / i for first < i <= last
+static std::pair<BigInt, BigInt> HarmonicSum(const int first, const int last)
+{
+    std::vector<std::pair<BigInt, BigInt>> v;
+    v.reserve(static_cast<std::size_t>(last - first));
+    for (int i{first + 1}; i <= last; ++i)
+        v.emplace_back(ONE, BigInt(std::to_string(i)));
+    auto sum = [](const std::pair<BigInt, BigInt>& x, const std::pair<BigInt, BigInt>& y)
+    {
+        auto p = x.first * y.second;
+        AddMul(p, y.first, x.second);
+        return std::make_pair(std::move(p), x.second * y.second);
+    };
+    auto digits = [](const std::pair<BigInt, BigInt>& x)
+    {
+        return IntegerLength(x.first) + IntegerLength(x.second);
+    };
+    return FoldBalanced(v, sum, digits);
+}
 BigFrac Harmonic(const int n)
 {
     if (n < 0)
@@ -922,39 +4829,299 @@ BigFrac Harmonic(const int n)
     }
     if (n == 0)
         return F_ZERO;
-    BigFrac x{F_ONE};
-    BigFrac t{F_ONE};
-    for (int i{2}; i <= n; ++i)
+    auto& cache = MemoCache::Instance();
+    if (n < CACHE_STRIDE || !cache.Enabled())
     {
-        t.denom = std::to_string(i);
-        x += t;
+        // Partial sums are reduced once at the end, which takes most of the time
+        std::pair<BigInt, BigInt> h;
+        {
+            ProgressStage stage(0., .1);
+            h = HarmonicSum(0, n);
+        }
+        ProgressStage stage(.1, 1.);
+        return BigFrac(h.first, h.second);
     }
-    return x;
+    // Resumes from the nearest checkpoint and stores the last one passed
+    auto c = cache.Find(CacheFunction::Harmonic, n);
+    auto start = c ? c->n : 0, last = n / CACHE_STRIDE * CACHE_STRIDE;
+    BigFrac z;
+    if (c)
+    {
+        z.num = c->values[0];
+        z.denom = c->values[1];
+    }
+    auto add = [&z](const std::pair<BigInt, BigInt>& h)
+    {
+        auto p = z.num * h.second;
+        AddMul(p, h.first, z.denom);
+        z = BigFrac(p, z.denom * h.second);
+    };
+    if (last > start)
+    {
+        add(HarmonicSum(start, last));
+        cache.Insert(CacheFunction::Harmonic, last, {z.num, z.denom});
+    }
+    if (n > last)
+        add(HarmonicSum(last, n));
+    return z;
+}
+
+static std::mutex executor_mutex;
+static Executor executor;
+
+void SetExecutor(Executor f)
+{
+    std::lock_guard<std::mutex> lock(executor_mutex);
+    executor = std::move(f);
+}
+// Runs f on the executor, or on a new thread without one, and hands its result or exception
+// to the returned future
+template <typename T, typename F>
+static std::future<T> RunAsync(const F& f, StopCondition stop, ProgressCallback progress)
+{
+    auto promise = std::make_shared<std::promise<T>>();
+    auto future = promise->get_future();
+    std::function<void()> task = [promise, f, stop = std::move(stop), progress = std::move(progress)]
+    {
+        AsyncCall call{&stop, &progress};
+        auto outer = async_call;
+        async_call = &call;
+        try
+        {
+            SafePoint();
+            auto z = f();
+            if (progress)
+                progress(1.);
+            promise->set_value(std::move(z));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+        async_call = outer;
+    };
+    Executor run;
+    {
+        std::lock_guard<std::mutex> lock(executor_mutex);
+        run = executor;
+    }
+    if (run)
+        run(std::move(task));
+    else
+        std::thread(std::move(task)).detach();
+    return future;
+}
+std::future<BigInt> FactorialAsync(const int n, StopCondition stop, ProgressCallback progress)
+{
+    return RunAsync<BigInt>([n]{return Factorial(n);}, std::move(stop), std::move(progress));
+}
+std::future<BigInt> FibonacciAsync(const int n, StopCondition stop, ProgressCallback progress)
+{
+    return RunAsync<BigInt>([n]{return Fibonacci(n);}, std::move(stop), std::move(progress));
+}
+std::future<BigInt> PowAsync(const BigInt& x, const int y, StopCondition stop, ProgressCallback progress)
+{
+    return RunAsync<BigInt>([x, y]{return x ^ y;}, std::move(stop), std::move(progress));
+}
+std::future<BigFrac> HarmonicAsync(const int n, StopCondition stop, ProgressCallback progress)
+{
+    return RunAsync<BigFrac>([n]{return Harmonic(n);}, std::move(stop), std::move(progress));
+}
+// The first 17 digits of v as d.ddd
+static double Mantissa(const std::string& v)
+{
+    char buffer[20]{};
+    buffer[0] = v[0];
+    buffer[1] = '.';
+    v.copy(buffer + 2, std::min<std::size_t>(v.length(), 17) - 1, 1);
+    return std::strtod(buffer, nullptr);
 }
 std::string Approx(const BigFrac& x)
 {
-    std::string s;
-    if (x.num.get_sign())
-        s.push_back('-');
-    auto exp_num = x.num.get_value().length() - 1;
-    auto exp_denom = x.denom.get_value().length() - 1;
-    long long exponent = exp_num - exp_denom;
-    std::string s_num = x.num.get_value().substr(0, std::min(x.num.get_value().length(), 17ull));
-    std::string s_denom = x.denom.get_value().substr(0, std::min(x.denom.get_value().length(), 17ull));
-    s_num.insert(1, 1, '.');
-    s_denom.insert(1, 1, '.');
-    double m_num = std::stod(s_num);
-    double m_denom = std::stod(s_denom);
-    double mantissa = m_num / m_denom;
+    auto exponent = static_cast<long long>(x.num.get_value().length()) - static_cast<long long>(x.denom.get_value().length());
+    double mantissa = Mantissa(x.num.get_value()) / Mantissa(x.denom.get_value());
     if (mantissa < 1.)
     {
         mantissa *= 10.;
         --exponent;
     }
-    std::stringstream ss;
-    ss.precision(16);
-    ss << mantissa;
-    s += ss.str() + " x 10 ^ " + std::to_string(exponent);
-    return s;
+    char buffer[64];
+    auto n = std::snprintf(buffer, sizeof(buffer), "%s%.16g x 10 ^ %lld", x.num.get_sign() ? "-" : "", mantissa, exponent);
+    return std::string(buffer, static_cast<std::size_t>(n));
+}
+
+std::to_chars_result ToChars(char* first, char* last, const BigFrac& x, const int base)
+{
+    FormatSpec spec;
+    spec.base = base;
+    return ToChars(first, last, x, spec);
+}
+std::to_chars_result ToChars(char* first, char* last, const BigFrac& x, const FormatSpec& spec)
+{
+    auto r = IntegerToChars(first, last, x.get_numerator(), spec);
+    if (r.ec != std::errc{})
+        return r;
+    if (last - r.ptr < 3)
+        return {last, std::errc::value_too_large};
+    auto p = std::copy_n(" / ", 3, r.ptr);
+    auto denom = spec;
+    denom.plus = false;
+    r = IntegerToChars(p, last, x.get_denominator(), denom);
+    if (r.ec != std::errc{})
+        return r;
+    return Pad(first, r.ptr, last, spec, x.get_numerator().get_sign() || spec.plus ? 1 : 0);
+}
+std::size_t FormattedSize(const BigFrac& x, const int base)
+{
+    return FormattedSize(x.get_numerator(), base) + 3 + FormattedSize(x.get_denominator(), base);
+}
+std::size_t FormattedSize(const BigFrac& x, const FormatSpec& spec)
+{
+    auto denom = spec;
+    denom.plus = false;
+    return PaddedSize(UnpaddedSize(x.get_numerator(), spec) + 3 + UnpaddedSize(x.get_denominator(), denom), x.get_numerator(), spec);
+}
+
+std::size_t BinarySize(const BigFrac& x)
+{
+    return 1 + IntegerBinarySize(x.get_numerator()) + IntegerBinarySize(x.get_denominator());
+}
+char* WriteBinary(char* out, const BigFrac& x)
+{
+    auto p = reinterpret_cast<unsigned char*>(out);
+    *p++ = BINARY_VERSION;
+    p = WriteInteger(p, x.get_numerator());
+    return reinterpret_cast<char*>(WriteInteger(p, x.get_denominator()));
+}
+std::ostream& WriteBinary(std::ostream& out, const BigFrac& x)
+{
+    std::string buffer(BinarySize(x), '\0');
+    WriteBinary(&buffer[0], x);
+    return out.write(buffer.data(), buffer.size());
+}
+BigFrac ReadBigFrac(std::istream& in)
+{
+    // Both parts are parsed as versioned records
+    std::string num, denom(1, static_cast<char>(BINARY_VERSION));
+    ReadVersion(in, num);
+    ReadIntegerBytes(in, num);
+    ReadIntegerBytes(in, denom);
+    // The fraction was reduced when it was written
+    BigFrac z;
+    z.num = BigIntView(num.data(), num.data() + num.size());
+    z.denom = BigIntView(denom.data(), denom.data() + denom.size());
+    if (z.denom.get_sign() || z.denom.get_value() == "0")
+        CorruptBinary();
+    return z;
+}
+
+
+void SetThreadCount(const unsigned n)
+{
+    ThreadPool::Instance().Resize(n);
+}
+unsigned ThreadCount()
+{
+    return ThreadPool::Instance().Size();
+}
+void SetParallelThreshold(const std::size_t digits)
+{
+    parallel_threshold = digits;
+}
+std::size_t ParallelThreshold()
+{
+    return parallel_threshold;
+}
+void SetTuning(const BigIntTuning& t)
+{
+    limb_threshold = std::max<std::size_t>(t.limb_threshold, 1);
+    karatsuba_threshold = std::max(t.karatsuba_threshold, MIN_KARATSUBA_THRESHOLD);
+    shift_multiply_threshold = t.shift_multiply_threshold;
+    parallel_threshold = t.parallel_threshold;
+}
+BigIntTuning Tuning()
+{
+    return {limb_threshold, karatsuba_threshold, shift_multiply_threshold, parallel_threshold};
+}
+
+BigIntStats Stats()
+{
+#ifdef BIGINT_STATS
+    return StatsRegistry::Instance().Snapshot(false);
+#else
+    return BigIntStats();
+#endif
+}
+void ResetStats()
+{
+#ifdef BIGINT_STATS
+    StatsRegistry::Instance().Snapshot(true);
+#endif
+}
+const char* StatsName(const StatsOperation op)
+{
+    static const char* const names[] = {
+        "Add", "Subtract", "Multiply", "Divide", "Remainder", "Pow", "AddMul", "SubMul", "MulMod", "GCD",
+        "ISqrt", "Factorial", "Fibonacci", "Binomial", "Bitwise", "Shift", "Parse", "Format"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<std::size_t>(StatsOperation::Count));
+    auto i = static_cast<std::size_t>(op);
+    return i < static_cast<std::size_t>(StatsOperation::Count) ? names[i] : "";
+}
+const char* StatsName(const MultiplyTier tier)
+{
+    static const char* const names[] = {"Schoolbook", "Karatsuba", "ParallelKaratsuba"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<std::size_t>(MultiplyTier::Count));
+    auto i = static_cast<std::size_t>(tier);
+    return i < static_cast<std::size_t>(MultiplyTier::Count) ? names[i] : "";
 }
 
+void SetCacheLimit(const std::size_t bytes)
+{
+    MemoCache::Instance().SetLimit(bytes);
+}
+std::size_t CacheLimit()
+{
+    return MemoCache::Instance().Limit();
+}
+void PreloadCache(const CacheFunction f, const int n)
+{
+    if (!MemoCache::Instance().Enabled())
+        return;
+    // Each call resumes from the checkpoint stored by the previous one
+    switch (f)
+    {
+    case CacheFunction::Factorial:
+        for (auto k = CACHE_STRIDE; k <= n; k += CACHE_STRIDE)
+            Factorial(k);
+        break;
+    case CacheFunction::Fibonacci:
+        for (auto k = CACHE_STRIDE; k <= n; k += CACHE_STRIDE)
+            Fibonacci(k);
+        break;
+    case CacheFunction::Harmonic:
+        // Every reduction costs a GCD, so the checkpoints double
+        for (auto k = CACHE_STRIDE; k <= n; k *= 2)
+        {
+            Harmonic(k);
+            if (k > n / 2)
+                break;
+        }
+        break;
+    default:
+        break;
+    }
+}
+CacheInfo CacheStatus()
+{
+    return MemoCache::Instance().Info();
+}
+void EvictCache(const CacheFunction f)
+{
+    auto i = static_cast<std::size_t>(f);
+    if (i < CACHE_FUNCTIONS)
+        MemoCache::Instance().Evict(i, i + 1);
+}
+void EvictCache()
+{
+    MemoCache::Instance().Evict(0, CACHE_FUNCTIONS);
+}
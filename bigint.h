@@ -30,6 +30,27 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <functional>
+#include <future>
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_format
+#include <format>
+#include <memory>
+#include <algorithm>
+#endif
+
+class BigIntView;
+class BigIntFile;
 
 class BigInt
 {
@@ -41,6 +62,9 @@ public:
     BigInt(const std::string&);
     BigInt(std::string&&);
     BigInt(const char*);
+    BigInt(std::string_view, const int = 10);
+    BigInt(const BigIntView&);
+    explicit BigInt(const BigIntFile&);
 
     BigInt& operator=(const char*);
     BigInt& operator+=(const BigInt&);
@@ -49,11 +73,16 @@ public:
     BigInt& operator/=(const BigInt&);
     BigInt& operator%=(const BigInt&);
     BigInt& operator^=(const int);
+    BigInt& operator&=(const BigInt&);
+    BigInt& operator|=(const BigInt&);
+    BigInt& operator<<=(const int);
+    BigInt& operator>>=(const int);
 
     const std::string& get_value() const;
     bool get_sign() const;
     
     friend std::ostream& operator<<(std::ostream&, const BigInt&);
+    friend std::from_chars_result FromChars(const char*, const char*, BigInt&, const int);
 
     friend BigInt operator+(const BigInt&, const BigInt&);
     friend BigInt operator-(const BigInt&, const BigInt&);
@@ -62,6 +91,12 @@ public:
     friend BigInt operator/(const BigInt&, const BigInt&);
     friend BigInt operator%(const BigInt&, const BigInt&);
     friend BigInt operator^(const BigInt&, const int);
+    friend BigInt operator&(const BigInt&, const BigInt&);
+    friend BigInt operator|(const BigInt&, const BigInt&);
+    friend BigInt operator~(const BigInt&);
+    friend BigInt operator<<(const BigInt&, const int);
+    friend BigInt operator>>(const BigInt&, const int);
+    friend BigInt BitXor(const BigInt&, const BigInt&);
 
     friend bool operator>=(const BigInt&, const BigInt&);
     friend bool operator<=(const BigInt&, const BigInt&);
@@ -80,7 +115,23 @@ public:
     friend bool EvenQ(const BigInt&);
     friend bool OddQ(const BigInt&);
     friend std::size_t IntegerLength(const BigInt&);
+    friend std::size_t BitLength(const BigInt&);
+    friend std::size_t PopCount(const BigInt&);
+    friend bool TestBit(const BigInt&, const int);
     friend std::string Approx(const BigInt&, const std::size_t);
+    friend BigInt& AddMul(BigInt&, const BigInt&, const BigInt&);
+    friend BigInt& SubMul(BigInt&, const BigInt&, const BigInt&);
+    friend BigInt MulMod(const BigInt&, const BigInt&, const BigInt&);
+    friend BigInt PowerMod(const BigInt&, const BigInt&, const BigInt&);
+    friend bool PrimeQ(const BigInt&, const int);
+    friend BigInt PrevPrime(const BigInt&);
+    friend BigInt RandomBelow(const BigInt&);
+    friend std::vector<std::pair<BigInt, int>> FactorInteger(const BigInt&);
+    friend void AddN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+    friend void MulN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+    friend void ModN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+    friend BigInt operator+(const BigIntView&, const BigIntView&);
+    friend BigInt operator*(const BigIntView&, const BigIntView&);
 };
 
 inline BigInt Add(const BigInt& x, const BigInt& y){return x + y;}
@@ -90,6 +141,11 @@ inline BigInt Multiply(const BigInt& x, const BigInt& y){return x * y;}
 inline BigInt Divide(const BigInt& x, const BigInt& y){return x / y;}
 inline BigInt Remainder(const BigInt& x, const BigInt& y){return x % y;}
 inline BigInt Pow(const BigInt& x, const int y){return x ^ y;}
+inline BigInt BitAnd(const BigInt& x, const BigInt& y){return x & y;}
+inline BigInt BitOr(const BigInt& x, const BigInt& y){return x | y;}
+inline BigInt BitNot(const BigInt& x){return ~x;}
+inline BigInt BitShiftLeft(const BigInt& x, const int y){return x << y;}
+inline BigInt BitShiftRight(const BigInt& x, const int y){return x >> y;}
 
 inline bool EqualQ(const BigInt& x, const BigInt& y){return x == y;}
 inline bool NotEqualQ(const BigInt& x, const BigInt& y){return x != y;}
@@ -98,6 +154,58 @@ inline bool LessQ(const BigInt& x, const BigInt& y){return x < y;}
 inline bool GreaterEqualQ(const BigInt& x, const BigInt& y){return x >= y;}
 inline bool LessEqualQ(const BigInt& x, const BigInt& y){return x <= y;}
 
+std::from_chars_result FromChars(const char*, const char*, BigInt&, const int = 10);
+
+// Layout of ToChars and std::format output, written as [[fill]align][+][0][width][separator][type]
+struct FormatSpec
+{
+    char fill = ' ';
+    char align = '\0'; // '<', '>' or '^', numbers are right-aligned by default
+    bool plus = false; // '+' on non-negative numbers
+    bool zero = false; // '0' pads with zeros after the sign
+    std::size_t width = 0;
+    char separator = '\0'; // ',', '_' or '\'' between groups of 3 decimal or 4 other digits
+    int base = 10; // type 'b', 'o', 'd', 'x' or 'X'
+    bool upper = false;
+};
+
+// Parses a format specification up to '}' or last and returns where it stopped
+constexpr const char* ParseFormatSpec(const char* first, const char* last, FormatSpec& spec)
+{
+    auto align_q = [](const char c){return c == '<' || c == '>' || c == '^';};
+    auto p = first;
+    if (last - p > 1 && align_q(p[1]) && *p != '{' && *p != '}')
+    {
+        spec.fill = p[0];
+        spec.align = p[1];
+        p += 2;
+    }
+    else if (p != last && align_q(*p))
+        spec.align = *p++;
+    if (p != last && (*p == '+' || *p == '-'))
+        spec.plus = *p++ == '+';
+    if (p != last && *p == '0')
+    {
+        spec.zero = true;
+        ++p;
+    }
+    for (; p != last && *p >= '0' && *p <= '9'; ++p)
+        spec.width = spec.width * 10 + static_cast<std::size_t>(*p - '0');
+    if (p != last && (*p == ',' || *p == '_' || *p == '\''))
+        spec.separator = *p++;
+    if (p != last && (*p == 'b' || *p == 'o' || *p == 'd' || *p == 'x' || *p == 'X'))
+    {
+        spec.base = *p == 'b' ? 2 : *p == 'o' ? 8 : *p == 'd' ? 10 : 16;
+        spec.upper = *p++ == 'X';
+    }
+    return p;
+}
+
+std::to_chars_result ToChars(char*, char*, const BigInt&, const int = 10);
+std::to_chars_result ToChars(char*, char*, const BigInt&, const FormatSpec&);
+std::size_t FormattedSize(const BigInt&, const int = 10);
+std::size_t FormattedSize(const BigInt&, const FormatSpec&);
+
 BigInt Abs(const BigInt&);
 BigInt Factorial(const int);
 BigInt GCD(const BigInt&, const BigInt&);
@@ -108,7 +216,203 @@ BigInt Binomial(const int, const int);
 bool EvenQ(const BigInt&);
 bool OddQ(const BigInt&);
 std::size_t IntegerLength(const BigInt&);
+BigInt BitXor(const BigInt&, const BigInt&);
+std::size_t BitLength(const BigInt&);
+std::size_t PopCount(const BigInt&);
+bool TestBit(const BigInt&, const int);
 std::string Approx(const BigInt&, const std::size_t = 10ull);
+BigInt& AddMul(BigInt&, const BigInt&, const BigInt&);
+BigInt& SubMul(BigInt&, const BigInt&, const BigInt&);
+BigInt MulMod(const BigInt&, const BigInt&, const BigInt&);
+BigInt PowerMod(const BigInt&, const BigInt&, const BigInt&);
+bool PrimeQ(const BigInt&, const int = 0);
+BigInt NextPrime(const BigInt&);
+BigInt PrevPrime(const BigInt&);
+BigInt RandomBelow(const BigInt&);
+void SeedRandom(const std::uint64_t);
+std::vector<std::pair<BigInt, int>> FactorInteger(const BigInt&);
+
+void AddN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+void MulN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+void ModN(const BigInt*, const BigInt*, BigInt*, const std::size_t);
+
+BigInt Product(std::vector<BigInt>);
+BigInt Sum(std::vector<BigInt>);
+BigInt LCM(std::vector<BigInt>);
+
+template <typename InputIt>
+using EnableIfBigIntIterator = std::enable_if_t<
+    std::is_convertible<typename std::iterator_traits<InputIt>::value_type, BigInt>::value>;
+
+template <typename InputIt, typename = EnableIfBigIntIterator<InputIt>>
+BigInt Product(InputIt first, InputIt last){return Product(std::vector<BigInt>(first, last));}
+template <typename InputIt, typename = EnableIfBigIntIterator<InputIt>>
+BigInt Sum(InputIt first, InputIt last){return Sum(std::vector<BigInt>(first, last));}
+template <typename InputIt, typename = EnableIfBigIntIterator<InputIt>>
+BigInt LCM(InputIt first, InputIt last){return LCM(std::vector<BigInt>(first, last));}
+
+void SetThreadCount(const unsigned);
+unsigned ThreadCount();
+void SetParallelThreshold(const std::size_t);
+std::size_t ParallelThreshold();
+
+// Crossover points between algorithms, measured on the host by bigint_tune
+struct BigIntTuning
+{
+    std::size_t limb_threshold;           // digits: shorter factors are multiplied digit by digit
+    std::size_t karatsuba_threshold;      // limbs of 9 digits: shorter factors use schoolbook, at least 4
+    std::size_t shift_multiply_threshold; // bits: longer left shifts multiply by a power of two
+    std::size_t parallel_threshold;       // digits: larger Karatsuba splits run on the thread pool
+};
+
+void SetTuning(const BigIntTuning&);
+BigIntTuning Tuning();
+
+// Operation counters, recorded only when the library is built with BIGINT_STATS
+enum class StatsOperation
+{
+    Add, Subtract, Multiply, Divide, Remainder, Pow, AddMul, SubMul, MulMod, GCD, ISqrt,
+    Factorial, Fibonacci, Binomial, Bitwise, Shift, Parse, Format, Count
+};
+enum class MultiplyTier {Schoolbook, Karatsuba, ParallelKaratsuba, Count};
+
+// Operand sizes are bucketed by decimal digits: 1-9, 10-99, ..., 10^7 and more
+constexpr std::size_t STATS_SIZE_BUCKETS = 8;
+
+struct OperationStats
+{
+    std::uint64_t calls = 0;
+    std::uint64_t nanoseconds = 0;
+    std::uint64_t sizes[STATS_SIZE_BUCKETS] = {};
+};
+
+struct BigIntStats
+{
+    OperationStats operations[static_cast<std::size_t>(StatsOperation::Count)] = {};
+    std::uint64_t multiply_tiers[static_cast<std::size_t>(MultiplyTier::Count)] = {};
+    std::uint64_t allocations = 0;
+    std::uint64_t allocated_bytes = 0;
+
+    const OperationStats& operator[](const StatsOperation op) const {return operations[static_cast<std::size_t>(op)];}
+    std::uint64_t operator[](const MultiplyTier tier) const {return multiply_tiers[static_cast<std::size_t>(tier)];}
+};
+
+BigIntStats Stats();
+void ResetStats();
+const char* StatsName(const StatsOperation);
+const char* StatsName(const MultiplyTier);
+
+// Opt-in memoization: Factorial, Fibonacci and Harmonic keep checkpoints at multiples of
+// CACHE_STRIDE and resume from the nearest one below their argument; Binomial shares the
+// factorial checkpoints. The cache is disabled until SetCacheLimit sets a size in bytes.
+enum class CacheFunction {Factorial, Fibonacci, Harmonic, Count};
+
+constexpr int CACHE_STRIDE = 1000;
+
+struct CacheInfo
+{
+    std::size_t checkpoints[static_cast<std::size_t>(CacheFunction::Count)] = {};
+    int largest[static_cast<std::size_t>(CacheFunction::Count)] = {};
+    std::size_t bytes = 0;
+    std::size_t limit = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+void SetCacheLimit(const std::size_t);
+std::size_t CacheLimit();
+void PreloadCache(const CacheFunction, const int);
+CacheInfo CacheStatus();
+void EvictCache(const CacheFunction);
+void EvictCache();
+
+std::size_t BinarySize(const BigInt&);
+char* WriteBinary(char*, const BigInt&);
+std::ostream& WriteBinary(std::ostream&, const BigInt&);
+BigInt ReadBigInt(std::istream&);
+
+// Non-owning view of a BigInt written by WriteBinary, e.g. inside a memory-mapped file
+class BigIntView
+{
+private:
+    const unsigned char* limbs = nullptr;
+    std::size_t size = 0;
+    bool sign = false;
+public:
+    BigIntView()=default;
+    BigIntView(const char*, const char*);
+
+    bool get_sign() const;
+    const char* get_end() const;
+
+    friend class BigInt;
+
+    friend BigInt operator+(const BigIntView&, const BigIntView&);
+    friend BigInt operator-(const BigIntView&, const BigIntView&);
+    friend BigInt operator*(const BigIntView&, const BigIntView&);
+
+    friend bool operator>=(const BigIntView&, const BigIntView&);
+    friend bool operator<=(const BigIntView&, const BigIntView&);
+    friend bool operator==(const BigIntView&, const BigIntView&);
+    friend bool operator!=(const BigIntView&, const BigIntView&);
+    friend bool operator>(const BigIntView&, const BigIntView&);
+    friend bool operator<(const BigIntView&, const BigIntView&);
+
+    friend bool EvenQ(const BigIntView&);
+    friend bool OddQ(const BigIntView&);
+    friend std::size_t IntegerLength(const BigIntView&);
+};
+
+bool EvenQ(const BigIntView&);
+bool OddQ(const BigIntView&);
+std::size_t IntegerLength(const BigIntView&);
+
+// Integer kept in a file, for values larger than memory. The magnitude is stored as the limbs
+// of the binary format; results are written to temporary files in the scratch directory, which
+// are removed with their BigIntFile. Arithmetic reads and writes the limbs sequentially in
+// blocks bounded by FileMemory().
+class BigIntFile
+{
+private:
+    std::string path;
+    std::uint64_t offset = 0; // of the first limb
+    std::uint64_t size = 0;   // limbs
+    bool sign = false;
+    bool temporary = false;
+    BigIntFile(std::string, const std::uint64_t, const bool);
+public:
+    BigIntFile()=default;
+    explicit BigIntFile(const BigInt&);
+    // Opens a file written by WriteBinary in place, without taking ownership of it
+    static BigIntFile Open(const std::string&);
+    BigIntFile(BigIntFile&&) noexcept;
+    BigIntFile& operator=(BigIntFile&&) noexcept;
+    BigIntFile(const BigIntFile&)=delete;
+    BigIntFile& operator=(const BigIntFile&)=delete;
+    ~BigIntFile();
+
+    bool get_sign() const;
+    const std::string& get_path() const;
+
+    friend class BigInt;
+
+    friend std::ostream& operator<<(std::ostream&, const BigIntFile&);
+
+    friend BigIntFile operator+(const BigIntFile&, const BigIntFile&);
+    friend BigIntFile operator-(const BigIntFile&, const BigIntFile&);
+    friend BigIntFile operator*(const BigIntFile&, const BigIntFile&);
+
+    friend std::size_t IntegerLength(const BigIntFile&);
+    friend std::ostream& WriteBinary(std::ostream&, const BigIntFile&);
+};
+
+std::size_t IntegerLength(const BigIntFile&);
+std::ostream& WriteBinary(std::ostream&, const BigIntFile&);
+
+void SetScratchDirectory(const std::string&);
+std::string ScratchDirectory();
+void SetFileMemory(const std::size_t);
+std::size_t FileMemory();
 
 class BigFrac
 {
@@ -146,7 +450,11 @@ public:
 
     friend BigFrac Abs(const BigFrac&);
     friend BigFrac Harmonic(const int);
+    friend std::vector<BigInt> ContinuedFraction(const BigFrac&);
+    friend BigFrac FromContinuedFraction(const std::vector<BigInt>&);
+    friend BigFrac LimitDenominator(const BigFrac&, const BigInt&);
     friend std::string Approx(const BigFrac&);
+    friend BigFrac ReadBigFrac(std::istream&);
 };
 
 inline BigFrac Add(const BigFrac& x, const BigFrac& y){return x + y;}
@@ -165,5 +473,718 @@ inline bool LessEqualQ(const BigFrac& x, const BigFrac& y){return x <= y;}
 
 BigFrac Abs(const BigFrac&);
 BigFrac Harmonic(const int);
+std::vector<BigInt> ContinuedFraction(const BigFrac&);
+BigFrac FromContinuedFraction(const std::vector<BigInt>&);
+BigFrac LimitDenominator(const BigFrac&, const BigInt&);
+BigFrac Simplest(BigFrac, BigFrac);
 
 std::string Approx(const BigFrac&);
+
+std::size_t BinarySize(const BigFrac&);
+char* WriteBinary(char*, const BigFrac&);
+std::ostream& WriteBinary(std::ostream&, const BigFrac&);
+BigFrac ReadBigFrac(std::istream&);
+
+std::to_chars_result ToChars(char*, char*, const BigFrac&, const int = 10);
+std::to_chars_result ToChars(char*, char*, const BigFrac&, const FormatSpec&);
+std::size_t FormattedSize(const BigFrac&, const int = 10);
+std::size_t FormattedSize(const BigFrac&, const FormatSpec&);
+
+// Asynchronous variants of the longest computations. They run on the executor set by
+// SetExecutor, a new thread for each call by default. stop is polled at safe points between
+// the steps of the computation, after which the future throws Cancelled, and progress gets
+// the completed fraction of the work on the computing thread.
+class Cancelled : public std::runtime_error
+{
+public:
+    Cancelled() : std::runtime_error("Computation cancelled") {}
+};
+
+// A predicate, or a token with stop_requested() such as std::stop_token
+class StopCondition
+{
+private:
+    std::function<bool()> f;
+public:
+    StopCondition()=default;
+    template <typename F, std::enable_if_t<std::is_invocable_r_v<bool, const F&>, int> = 0>
+    StopCondition(F predicate) : f(std::move(predicate)) {}
+    template <typename T, typename = decltype(std::declval<const T&>().stop_requested())>
+    StopCondition(T token) : f([token]{return token.stop_requested();}) {}
+
+    bool operator()() const {return f && f();}
+};
+
+using ProgressCallback = std::function<void(double)>;
+using Executor = std::function<void(std::function<void()>)>;
+
+void SetExecutor(Executor);
+
+std::future<BigInt> FactorialAsync(const int, StopCondition = {}, ProgressCallback = {});
+std::future<BigInt> FibonacciAsync(const int, StopCondition = {}, ProgressCallback = {});
+std::future<BigInt> PowAsync(const BigInt&, const int, StopCondition = {}, ProgressCallback = {});
+std::future<BigFrac> HarmonicAsync(const int, StopCondition = {}, ProgressCallback = {});
+
+// Integer of a fixed width of Bits bits in two's complement, kept in 32-bit limbs on the
+// stack. Arithmetic wraps modulo 2^Bits, division truncates toward zero, and bitwise
+// operations and shifts act on the two's complement like they do for BigInt. Everything
+// except the conversions to BigInt, strings and streams can be evaluated at compile time.
+template <std::size_t Bits>
+class FixedBigInt
+{
+    static_assert(Bits > 0 && Bits % 32 == 0, "FixedBigInt width must be a positive multiple of 32 bits");
+    template <std::size_t> friend class FixedBigInt;
+public:
+    static constexpr std::size_t LIMBS = Bits / 32;
+private:
+    using Limb = std::uint32_t;
+    Limb limbs[LIMBS] = {}; // least significant first
+
+    constexpr bool Negative() const {return limbs[LIMBS - 1] >> 31 != 0;}
+    constexpr bool ZeroQ() const
+    {
+        for (auto d : limbs)
+            if (d != 0)
+                return false;
+        return true;
+    }
+    constexpr void Negate()
+    {
+        std::uint64_t c{1};
+        for (auto& d : limbs)
+        {
+            c += static_cast<Limb>(~d);
+            d = static_cast<Limb>(c);
+            c >>= 32;
+        }
+    }
+    // The magnitude read as an unsigned number, 2^(Bits-1) for the most negative value
+    constexpr FixedBigInt Magnitude() const
+    {
+        auto z = *this;
+        if (Negative())
+            z.Negate();
+        return z;
+    }
+    // *this = *this * m + a, all unsigned
+    constexpr void MulAdd(const Limb m, const Limb a)
+    {
+        std::uint64_t c{a};
+        for (auto& d : limbs)
+        {
+            c += std::uint64_t{d} * m;
+            d = static_cast<Limb>(c);
+            c >>= 32;
+        }
+    }
+    // *this /= d as an unsigned number, returns the remainder
+    constexpr Limb DivideLimb(const Limb d)
+    {
+        std::uint64_t r{};
+        for (auto i = LIMBS; i-- > 0;)
+        {
+            r = r << 32 | limbs[i];
+            limbs[i] = static_cast<Limb>(r / d);
+            r %= d;
+        }
+        return static_cast<Limb>(r);
+    }
+    constexpr void ShiftLeft(const std::size_t s)
+    {
+        auto w = s / 32;
+        auto b = static_cast<unsigned>(s % 32);
+        for (auto i = LIMBS; i-- > 0;)
+        {
+            Limb d{};
+            if (i >= w)
+            {
+                d = limbs[i - w] << b;
+                if (b != 0 && i > w)
+                    d |= limbs[i - w - 1] >> (32 - b);
+            }
+            limbs[i] = d;
+        }
+    }
+    // Shifts in copies of fill: all ones for an arithmetic shift of a negative number
+    constexpr void ShiftRight(const std::size_t s, const Limb fill)
+    {
+        auto w = s / 32;
+        auto b = static_cast<unsigned>(s % 32);
+        for (std::size_t i{}; i < LIMBS; ++i)
+        {
+            auto lo = w < LIMBS - i ? limbs[i + w] : fill;
+            auto hi = w < LIMBS - i - 1 ? limbs[i + w + 1] : fill;
+            limbs[i] = b == 0 ? lo : (lo >> b | hi << (32 - b));
+        }
+    }
+    constexpr std::size_t TrailingZeros() const
+    {
+        std::size_t n{};
+        for (auto d : limbs)
+        {
+            if (d != 0)
+            {
+                for (; (d & 1) == 0; d >>= 1)
+                    ++n;
+                return n;
+            }
+            n += 32;
+        }
+        return n;
+    }
+    static constexpr int CompareUnsigned(const FixedBigInt& x, const FixedBigInt& y)
+    {
+        for (auto i = LIMBS; i-- > 0;)
+            if (x.limbs[i] != y.limbs[i])
+                return x.limbs[i] < y.limbs[i] ? -1 : 1;
+        return 0;
+    }
+    // q = x / y and r = x % y as unsigned numbers, y != 0 (Knuth's algorithm D)
+    static constexpr void DivideUnsigned(const FixedBigInt& x, const FixedBigInt& y, FixedBigInt& q, FixedBigInt& r)
+    {
+        q = FixedBigInt();
+        r = FixedBigInt();
+        auto m = LIMBS, n = LIMBS;
+        while (m > 0 && x.limbs[m - 1] == 0)
+            --m;
+        while (n > 0 && y.limbs[n - 1] == 0)
+            --n;
+        if (CompareUnsigned(x, y) < 0)
+        {
+            r = x;
+            return;
+        }
+        if (n == 1)
+        {
+            q = x;
+            r.limbs[0] = q.DivideLimb(y.limbs[0]);
+            return;
+        }
+        if constexpr (LIMBS > 1)
+            DivideLimbs(x, y, m, n, q, r);
+    }
+    // Algorithm D for a divisor of n > 1 limbs and a dividend of m >= n limbs
+    static constexpr void DivideLimbs(const FixedBigInt& x, const FixedBigInt& y, const std::size_t m, const std::size_t n,
+        FixedBigInt& q, FixedBigInt& r)
+    {
+        // Normalizes the divisor so that its top limb has the high bit set
+        unsigned s{};
+        for (auto top = y.limbs[n - 1]; (top & 0x80000000u) == 0; top <<= 1)
+            ++s;
+        Limb u[LIMBS + 1] = {}, v[LIMBS] = {};
+        for (std::size_t i{}; i < n; ++i)
+            v[i] = y.limbs[i] << s | (s != 0 && i > 0 ? y.limbs[i - 1] >> (32 - s) : 0);
+        for (std::size_t i{}; i <= m; ++i)
+            u[i] = (i < m ? x.limbs[i] << s : 0) | (s != 0 && i > 0 ? x.limbs[i - 1] >> (32 - s) : 0);
+        constexpr std::uint64_t B = std::uint64_t{1} << 32;
+        for (auto j = m - n + 1; j-- > 0;)
+        {
+            auto top = std::uint64_t{u[j + n]} << 32 | u[j + n - 1];
+            auto qhat = top / v[n - 1], rhat = top % v[n - 1];
+            while (qhat >= B || qhat * v[n - 2] > (rhat << 32 | u[j + n - 2]))
+            {
+                --qhat;
+                rhat += v[n - 1];
+                if (rhat >= B)
+                    break;
+            }
+            std::int64_t borrow{};
+            std::uint64_t carry{};
+            for (std::size_t i{}; i < n; ++i)
+            {
+                auto p = qhat * v[i] + carry;
+                carry = p >> 32;
+                auto t = std::int64_t{u[i + j]} - borrow - static_cast<std::int64_t>(p & 0xFFFFFFFFu);
+                u[i + j] = static_cast<Limb>(t);
+                borrow = t < 0 ? 1 : 0;
+            }
+            auto t = std::int64_t{u[j + n]} - borrow - static_cast<std::int64_t>(carry);
+            u[j + n] = static_cast<Limb>(t);
+            // qhat was one too large: adds the divisor back
+            if (t < 0)
+            {
+                --qhat;
+                std::uint64_t c{};
+                for (std::size_t i{}; i < n; ++i)
+                {
+                    c += std::uint64_t{u[i + j]} + v[i];
+                    u[i + j] = static_cast<Limb>(c);
+                    c >>= 32;
+                }
+                u[j + n] += static_cast<Limb>(c);
+            }
+            q.limbs[j] = static_cast<Limb>(qhat);
+        }
+        for (std::size_t i{}; i < n; ++i)
+            r.limbs[i] = u[i] >> s | (s != 0 ? u[i + 1] << (32 - s) : 0);
+    }
+    static constexpr void DivMod(const FixedBigInt& x, const FixedBigInt& y, FixedBigInt* q, FixedBigInt* r)
+    {
+        if (y.ZeroQ())
+        {
+            throw std::runtime_error("Division by zero");
+        }
+        FixedBigInt a, b;
+        DivideUnsigned(x.Magnitude(), y.Magnitude(), a, b);
+        if (q != nullptr)
+        {
+            if (x.Negative() != y.Negative())
+                a.Negate();
+            *q = a;
+        }
+        if (r != nullptr)
+        {
+            if (x.Negative())
+                b.Negate();
+            *r = b;
+        }
+    }
+public:
+    constexpr FixedBigInt()=default;
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    constexpr FixedBigInt(const T x)
+    {
+        auto u = static_cast<unsigned long long>(x);
+        Limb fill{};
+        if constexpr (std::is_signed<T>::value)
+            fill = x < 0 ? ~Limb{} : Limb{};
+        for (std::size_t i{}; i < LIMBS; ++i)
+            limbs[i] = i < 2 ? static_cast<Limb>(u >> (32 * i)) : fill;
+    }
+    FixedBigInt(const std::string& s) : FixedBigInt(std::string_view(s)) {}
+    constexpr FixedBigInt(const char* s) : FixedBigInt(std::string_view(s)) {}
+    constexpr FixedBigInt(std::string_view s, const int base = 10)
+    {
+        if (base < 2 || base > 36)
+        {
+            throw std::domain_error("Base is not in the range 2 to 36");
+        }
+        auto space_q = [](const char c){return c == ' ' || (c >= '\t' && c <= '\r');};
+        auto digit = [](const char c)
+        {
+            return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'z' ? c - 'a' + 10 : c >= 'A' && c <= 'Z' ? c - 'A' + 10 : 36;
+        };
+        std::size_t i{};
+        while (i < s.size() && space_q(s[i]))
+            ++i;
+        bool sign{};
+        if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+            sign = s[i++] == '-';
+        auto first = i;
+        for (; i < s.size() && digit(s[i]) < base; ++i)
+            MulAdd(static_cast<Limb>(base), static_cast<Limb>(digit(s[i])));
+        auto last = i;
+        while (i < s.size() && space_q(s[i]))
+            ++i;
+        if (first == last || i != s.size())
+        {
+            throw std::invalid_argument("ERROR: Not a number");
+        }
+        if (sign)
+            Negate();
+    }
+    // Keeps the low Bits bits of the two's complement of x
+    explicit FixedBigInt(const BigInt& x)
+    {
+        const auto& v = x.get_value();
+        auto k = v.length() % 9 == 0 ? 9 : v.length() % 9;
+        for (std::size_t i{}; i < v.length(); i += k, k = 9)
+        {
+            Limb chunk{}, scale{1};
+            for (std::size_t j{}; j < k; ++j)
+            {
+                chunk = chunk * 10 + static_cast<Limb>(v[i + j] - '0');
+                scale *= 10;
+            }
+            MulAdd(scale, chunk);
+        }
+        if (x.get_sign())
+            Negate();
+    }
+    explicit operator BigInt() const
+    {
+        auto s = get_value();
+        if (Negative())
+            s.insert(0, 1, '-');
+        return BigInt(std::move(s));
+    }
+
+    // Decimal digits of the magnitude, as BigInt::get_value
+    std::string get_value() const
+    {
+        char buffer[LIMBS * 10];
+        auto end = buffer + sizeof(buffer), p = end;
+        auto m = Magnitude();
+        do
+        {
+            auto r = m.DivideLimb(1000000000);
+            auto zero_q = m.ZeroQ();
+            for (int k{}; k < 9 && (!zero_q || r != 0 || p == end); ++k)
+            {
+                *--p = static_cast<char>('0' + r % 10);
+                r /= 10;
+            }
+        } while (!m.ZeroQ());
+        return std::string(p, end);
+    }
+    constexpr bool get_sign() const {return Negative();}
+
+    friend std::ostream& operator<<(std::ostream& out, const FixedBigInt& x)
+    {
+        if (x.Negative())
+            out << '-';
+        return out << x.get_value();
+    }
+
+    constexpr FixedBigInt& operator+=(const FixedBigInt& x)
+    {
+        std::uint64_t c{};
+        for (std::size_t i{}; i < LIMBS; ++i)
+        {
+            c += std::uint64_t{limbs[i]} + x.limbs[i];
+            limbs[i] = static_cast<Limb>(c);
+            c >>= 32;
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator-=(const FixedBigInt& x)
+    {
+        std::uint64_t b{};
+        for (std::size_t i{}; i < LIMBS; ++i)
+        {
+            auto t = std::uint64_t{limbs[i]} - x.limbs[i] - b;
+            limbs[i] = static_cast<Limb>(t);
+            b = t >> 63;
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator*=(const FixedBigInt& x)
+    {
+        // Only the products that land in the low LIMBS limbs are computed
+        Limb r[LIMBS] = {};
+        for (std::size_t i{}; i < LIMBS; ++i)
+        {
+            if (limbs[i] == 0)
+                continue;
+            std::uint64_t c{};
+            for (std::size_t j{}; j < LIMBS - i; ++j)
+            {
+                c += std::uint64_t{limbs[i]} * x.limbs[j] + r[i + j];
+                r[i + j] = static_cast<Limb>(c);
+                c >>= 32;
+            }
+        }
+        for (std::size_t i{}; i < LIMBS; ++i)
+            limbs[i] = r[i];
+        return *this;
+    }
+    constexpr FixedBigInt& operator/=(const FixedBigInt& x)
+    {
+        DivMod(*this, x, this, nullptr);
+        return *this;
+    }
+    constexpr FixedBigInt& operator%=(const FixedBigInt& x)
+    {
+        DivMod(*this, x, nullptr, this);
+        return *this;
+    }
+    constexpr FixedBigInt& operator^=(const int p) {return *this = *this ^ p;}
+    constexpr FixedBigInt& operator&=(const FixedBigInt& x)
+    {
+        for (std::size_t i{}; i < LIMBS; ++i)
+            limbs[i] &= x.limbs[i];
+        return *this;
+    }
+    constexpr FixedBigInt& operator|=(const FixedBigInt& x)
+    {
+        for (std::size_t i{}; i < LIMBS; ++i)
+            limbs[i] |= x.limbs[i];
+        return *this;
+    }
+    constexpr FixedBigInt& operator<<=(const int p)
+    {
+        if (p < 0)
+        {
+            throw std::domain_error("Shift count is a negative integer");
+        }
+        ShiftLeft(static_cast<std::size_t>(p));
+        return *this;
+    }
+    // Rounds toward negative infinity
+    constexpr FixedBigInt& operator>>=(const int p)
+    {
+        if (p < 0)
+        {
+            throw std::domain_error("Shift count is a negative integer");
+        }
+        ShiftRight(static_cast<std::size_t>(p), Negative() ? ~Limb{} : Limb{});
+        return *this;
+    }
+
+    friend constexpr FixedBigInt operator+(FixedBigInt x, const FixedBigInt& y) {return x += y;}
+    friend constexpr FixedBigInt operator-(FixedBigInt x, const FixedBigInt& y) {return x -= y;}
+    friend constexpr FixedBigInt operator-(FixedBigInt x)
+    {
+        x.Negate();
+        return x;
+    }
+    friend constexpr FixedBigInt operator*(FixedBigInt x, const FixedBigInt& y) {return x *= y;}
+    friend constexpr FixedBigInt operator/(FixedBigInt x, const FixedBigInt& y) {return x /= y;}
+    friend constexpr FixedBigInt operator%(FixedBigInt x, const FixedBigInt& y) {return x %= y;}
+    friend constexpr FixedBigInt operator^(const FixedBigInt& x, const int y)
+    {
+        if (y < 0)
+        {
+            throw std::domain_error("Power is a negative integer");
+        }
+        if (x.ZeroQ() && y == 0)
+        {
+            throw std::domain_error("Indeterminate expression 0^0 encountered");
+        }
+        FixedBigInt z{1}, b{x};
+        for (int e{y}; e != 0; e /= 2)
+        {
+            if (e % 2 == 1)
+                z *= b;
+            if (e > 1)
+                b *= b;
+        }
+        return z;
+    }
+    friend constexpr FixedBigInt operator&(FixedBigInt x, const FixedBigInt& y) {return x &= y;}
+    friend constexpr FixedBigInt operator|(FixedBigInt x, const FixedBigInt& y) {return x |= y;}
+    friend constexpr FixedBigInt operator~(FixedBigInt x)
+    {
+        for (auto& d : x.limbs)
+            d = ~d;
+        return x;
+    }
+    friend constexpr FixedBigInt operator<<(FixedBigInt x, const int y) {return x <<= y;}
+    friend constexpr FixedBigInt operator>>(FixedBigInt x, const int y) {return x >>= y;}
+    friend constexpr FixedBigInt BitXor(FixedBigInt x, const FixedBigInt& y)
+    {
+        for (std::size_t i{}; i < LIMBS; ++i)
+            x.limbs[i] ^= y.limbs[i];
+        return x;
+    }
+
+    friend constexpr bool operator==(const FixedBigInt& x, const FixedBigInt& y) {return CompareUnsigned(x, y) == 0;}
+    friend constexpr bool operator!=(const FixedBigInt& x, const FixedBigInt& y) {return !(x == y);}
+    friend constexpr bool operator<(const FixedBigInt& x, const FixedBigInt& y)
+    {
+        if (x.Negative() != y.Negative())
+            return x.Negative();
+        return CompareUnsigned(x, y) < 0;
+    }
+    friend constexpr bool operator>(const FixedBigInt& x, const FixedBigInt& y) {return y < x;}
+    friend constexpr bool operator<=(const FixedBigInt& x, const FixedBigInt& y) {return !(y < x);}
+    friend constexpr bool operator>=(const FixedBigInt& x, const FixedBigInt& y) {return !(x < y);}
+
+    friend constexpr FixedBigInt Abs(const FixedBigInt& x) {return x.Magnitude();}
+    friend constexpr FixedBigInt GCD(const FixedBigInt& x, const FixedBigInt& y)
+    {
+        // Binary GCD on the magnitudes
+        auto a = x.Magnitude(), b = y.Magnitude();
+        if (a.ZeroQ())
+            return b;
+        if (b.ZeroQ())
+            return a;
+        auto k = a.TrailingZeros() < b.TrailingZeros() ? a.TrailingZeros() : b.TrailingZeros();
+        a.ShiftRight(a.TrailingZeros(), 0);
+        for (;;)
+        {
+            b.ShiftRight(b.TrailingZeros(), 0);
+            if (CompareUnsigned(a, b) > 0)
+            {
+                auto t = a;
+                a = b;
+                b = t;
+            }
+            b -= a;
+            if (b.ZeroQ())
+                break;
+        }
+        a.ShiftLeft(k);
+        return a;
+    }
+    friend constexpr FixedBigInt LCM(const FixedBigInt& x, const FixedBigInt& y)
+    {
+        if (x.ZeroQ() || y.ZeroQ())
+            return FixedBigInt();
+        return Abs(y) * (Abs(x) / GCD(x, y));
+    }
+    friend constexpr FixedBigInt ISqrt(const FixedBigInt& x)
+    {
+        if (x.Negative())
+        {
+            throw std::domain_error("Integer square root of a negative integer");
+        }
+        if (x < FixedBigInt{2})
+            return x;
+        // Newton's iteration decreases from a power of two above the root
+        FixedBigInt r{1};
+        r.ShiftLeft((BitLength(x) + 1) / 2);
+        for (;;)
+        {
+            auto y = r + x / r;
+            y.ShiftRight(1, 0);
+            if (!(y < r))
+                return r;
+            r = y;
+        }
+    }
+    friend constexpr bool EvenQ(const FixedBigInt& x) {return (x.limbs[0] & 1) == 0;}
+    friend constexpr bool OddQ(const FixedBigInt& x) {return (x.limbs[0] & 1) != 0;}
+    friend constexpr std::size_t IntegerLength(const FixedBigInt& x)
+    {
+        auto m = x.Magnitude();
+        std::size_t n{};
+        for (;;)
+        {
+            auto r = m.DivideLimb(1000000000);
+            if (m.ZeroQ())
+            {
+                for (n += 1; r >= 10; r /= 10)
+                    ++n;
+                return n;
+            }
+            n += 9;
+        }
+    }
+    // Negative numbers count the bits of -x - 1, as for BigInt
+    friend constexpr std::size_t BitLength(const FixedBigInt& x)
+    {
+        auto mask = x.Negative() ? ~Limb{} : Limb{};
+        for (auto i = LIMBS; i-- > 0;)
+        {
+            if (x.limbs[i] != mask)
+            {
+                std::size_t n{i * 32};
+                for (auto top = x.limbs[i] ^ mask; top != 0; top >>= 1)
+                    ++n;
+                return n;
+            }
+        }
+        return 0;
+    }
+    friend constexpr std::size_t PopCount(const FixedBigInt& x)
+    {
+        std::size_t n{};
+        for (auto d : x.Magnitude().limbs)
+            for (; d != 0; d &= d - 1)
+                ++n;
+        return n;
+    }
+    friend constexpr bool TestBit(const FixedBigInt& x, const int k)
+    {
+        if (k < 0)
+        {
+            throw std::domain_error("Bit index is a negative integer");
+        }
+        auto i = static_cast<std::size_t>(k / 32);
+        return i < LIMBS ? (x.limbs[i] >> (k % 32) & 1) != 0 : x.Negative();
+    }
+    friend constexpr FixedBigInt& AddMul(FixedBigInt& x, const FixedBigInt& y, const FixedBigInt& z) {return x += y * z;}
+    friend constexpr FixedBigInt& SubMul(FixedBigInt& x, const FixedBigInt& y, const FixedBigInt& z) {return x -= y * z;}
+    // x * y % m without wrapping, through a product of twice the width
+    friend constexpr FixedBigInt MulMod(const FixedBigInt& x, const FixedBigInt& y, const FixedBigInt& m)
+    {
+        if (m.ZeroQ())
+        {
+            throw std::runtime_error("Division by zero");
+        }
+        FixedBigInt<2 * Bits> a, b, c, q, r;
+        auto mx = x.Magnitude(), my = y.Magnitude(), mm = m.Magnitude();
+        for (std::size_t i{}; i < LIMBS; ++i)
+        {
+            a.limbs[i] = mx.limbs[i];
+            b.limbs[i] = my.limbs[i];
+            c.limbs[i] = mm.limbs[i];
+        }
+        a *= b;
+        FixedBigInt<2 * Bits>::DivideUnsigned(a, c, q, r);
+        FixedBigInt z;
+        for (std::size_t i{}; i < LIMBS; ++i)
+            z.limbs[i] = r.limbs[i];
+        if (x.Negative() != y.Negative())
+            z.Negate();
+        return z;
+    }
+};
+
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Add(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x + y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Subtract(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x - y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Minus(const FixedBigInt<Bits>& x){return -x;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Multiply(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x * y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Divide(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x / y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Remainder(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x % y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> Pow(const FixedBigInt<Bits>& x, const int y){return x ^ y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> BitAnd(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x & y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> BitOr(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x | y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> BitNot(const FixedBigInt<Bits>& x){return ~x;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> BitShiftLeft(const FixedBigInt<Bits>& x, const int y){return x << y;}
+template <std::size_t Bits>
+constexpr FixedBigInt<Bits> BitShiftRight(const FixedBigInt<Bits>& x, const int y){return x >> y;}
+
+template <std::size_t Bits>
+constexpr bool EqualQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x == y;}
+template <std::size_t Bits>
+constexpr bool NotEqualQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x != y;}
+template <std::size_t Bits>
+constexpr bool GreaterQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x > y;}
+template <std::size_t Bits>
+constexpr bool LessQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x < y;}
+template <std::size_t Bits>
+constexpr bool GreaterEqualQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x >= y;}
+template <std::size_t Bits>
+constexpr bool LessEqualQ(const FixedBigInt<Bits>& x, const FixedBigInt<Bits>& y){return x <= y;}
+
+#ifdef __cpp_lib_format
+template <typename T>
+struct BigNumberFormatter
+{
+    FormatSpec spec;
+
+    constexpr auto parse(std::format_parse_context& ctx)
+    {
+        auto first = std::to_address(ctx.begin());
+        auto last = first + (ctx.end() - ctx.begin());
+        auto p = ParseFormatSpec(first, last, spec);
+        if (p != last && *p != '}')
+            throw std::format_error("Invalid format specification for a big number");
+        return ctx.begin() + (p - first);
+    }
+    template <typename FormatContext>
+    auto format(const T& x, FormatContext& ctx) const
+    {
+        // Typical numbers are formatted on the stack
+        char buffer[256];
+        std::string heap;
+        auto first = buffer;
+        auto n = FormattedSize(x, spec);
+        if (n > sizeof(buffer))
+        {
+            heap.resize(n);
+            first = heap.data();
+        }
+        auto r = ToChars(first, first + n, x, spec);
+        return std::copy(first, r.ptr, ctx.out());
+    }
+};
+
+template <>
+struct std::formatter<BigInt> : BigNumberFormatter<BigInt> {};
+template <>
+struct std::formatter<BigFrac> : BigNumberFormatter<BigFrac> {};
+#endif
@@ -0,0 +1,1279 @@
+/*
+	bigint
+	
+	Copyright (c) 2025 Royal_X (MIT License)
+ 
+ 	https://github.com/RoyalXXX
+  	https://royalxxx.itch.io
+   	https://sourceforge.net/u/royal-x
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+	
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// bigint_test: checks the kernels of bigint.h against simple references, such as schoolbook
+// digit arithmetic, plain Euclid and native integers. The groups named on the command line
+// are run, all of them by default.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bigint.h"
+
+static int checks{};
+static int failures{};
+
+static void Check(const bool ok, const char* expression, const char* file, const int line)
+{
+    ++checks;
+    if (!ok)
+    {
+        ++failures;
+        std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed\n";
+    }
+}
+template <typename T, typename U>
+static void CheckEqual(const T& x, const U& y, const char* expression, const char* file, const int line)
+{
+    ++checks;
+    if (!(x == y))
+    {
+        ++failures;
+        std::cerr << file << ":" << line << ": CHECK_EQ(" << expression << ") failed\n  " << x << "\n  " << y << "\n";
+    }
+}
+
+#define CHECK(...) Check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+#define CHECK_EQ(x, y) CheckEqual((x), (y), #x ", " #y, __FILE__, __LINE__)
+#define CHECK_THROWS(E, ...)                      \
+    do                                            \
+    {                                             \
+        bool thrown_{};                           \
+        try                                       \
+        {                                         \
+            static_cast<void>(__VA_ARGS__);       \
+        }                                         \
+        catch (const E&)                          \
+        {                                         \
+            thrown_ = true;                       \
+        }                                         \
+        Check(thrown_, "throws " #E ": " #__VA_ARGS__, __FILE__, __LINE__); \
+    } while (false)
+
+static std::mt19937_64 rng{20250601};
+
+static std::uint64_t Uniform(const std::uint64_t lo, const std::uint64_t hi)
+{
+    return std::uniform_int_distribution<std::uint64_t>(lo, hi)(rng);
+}
+static long long UniformSigned(const long long lo, const long long hi)
+{
+    return std::uniform_int_distribution<long long>(lo, hi)(rng);
+}
+// n digits in runs of 9s, of 0s and of random digits, so that carries and borrows cross the
+// 8-digit words and the 9-digit limbs
+static std::string RandomDigits(const std::size_t n)
+{
+    std::string s;
+    while (s.length() < n)
+    {
+        auto kind = Uniform(0, 3);
+        for (auto run = Uniform(1, 24); run > 0; --run)
+            s.push_back(kind == 0 ? '9' : kind == 1 ? '0' : static_cast<char>('0' + Uniform(0, 9)));
+    }
+    s.resize(n);
+    s[0] = static_cast<char>('1' + Uniform(0, 8));
+    return s;
+}
+static BigInt RandomBigInt(const std::size_t n, const bool allow_negative = true)
+{
+    auto s = RandomDigits(n);
+    return BigInt(allow_negative && Uniform(0, 1) == 1 ? "-" + s : s);
+}
+static BigInt PowerOfTen(const std::size_t k)
+{
+    return BigInt("1" + std::string(k, '0'));
+}
+static BigInt FromInt(const long long x)
+{
+    return BigInt(std::to_string(x));
+}
+
+// Schoolbook arithmetic on the decimal digits of magnitudes, the reference for the products
+// and sums of the library
+static int CompareDigits(const std::string& a, const std::string& b)
+{
+    if (a.length() != b.length())
+        return a.length() < b.length() ? -1 : 1;
+    auto c = a.compare(b);
+    return c < 0 ? -1 : c > 0 ? 1 : 0;
+}
+static std::string TrimDigits(std::string s)
+{
+    auto i = s.find_first_not_of('0');
+    return i == std::string::npos ? "0" : s.substr(i);
+}
+static std::string AddDigits(const std::string& a, const std::string& b)
+{
+    std::string s;
+    int carry{};
+    for (std::size_t i{}; i < std::max(a.length(), b.length()) || carry != 0; ++i)
+    {
+        auto d = carry + (i < a.length() ? a[a.length() - 1 - i] - '0' : 0) + (i < b.length() ? b[b.length() - 1 - i] - '0' : 0);
+        s.push_back(static_cast<char>('0' + d % 10));
+        carry = d / 10;
+    }
+    std::reverse(s.begin(), s.end());
+    return TrimDigits(s);
+}
+// a - b for a >= b
+static std::string SubtractDigits(const std::string& a, const std::string& b)
+{
+    std::string s;
+    int borrow{};
+    for (std::size_t i{}; i < a.length(); ++i)
+    {
+        auto d = (a[a.length() - 1 - i] - '0') - borrow - (i < b.length() ? b[b.length() - 1 - i] - '0' : 0);
+        borrow = d < 0 ? 1 : 0;
+        s.push_back(static_cast<char>('0' + d + 10 * borrow));
+    }
+    std::reverse(s.begin(), s.end());
+    return TrimDigits(s);
+}
+static std::string MultiplyDigits(const std::string& a, const std::string& b)
+{
+    std::vector<std::uint64_t> t(a.length() + b.length());
+    for (std::size_t i{}; i < a.length(); ++i)
+        for (std::size_t j{}; j < b.length(); ++j)
+            t[i + j] += static_cast<std::uint64_t>((a[a.length() - 1 - i] - '0') * (b[b.length() - 1 - j] - '0'));
+    std::string s;
+    std::uint64_t carry{};
+    for (auto v : t)
+    {
+        v += carry;
+        s.push_back(static_cast<char>('0' + v % 10));
+        carry = v / 10;
+    }
+    std::reverse(s.begin(), s.end());
+    return TrimDigits(s);
+}
+static BigInt Signed(const bool negative, const std::string& magnitude)
+{
+    return BigInt(negative && magnitude != "0" ? "-" + magnitude : magnitude);
+}
+static BigInt NaiveAdd(const BigInt& x, const BigInt& y)
+{
+    const auto& a = x.get_value();
+    const auto& b = y.get_value();
+    if (x.get_sign() == y.get_sign())
+        return Signed(x.get_sign(), AddDigits(a, b));
+    if (CompareDigits(a, b) >= 0)
+        return Signed(x.get_sign(), SubtractDigits(a, b));
+    return Signed(y.get_sign(), SubtractDigits(b, a));
+}
+static BigInt NaiveSubtract(const BigInt& x, const BigInt& y)
+{
+    return NaiveAdd(x, Signed(!y.get_sign(), y.get_value()));
+}
+static BigInt NaiveMultiply(const BigInt& x, const BigInt& y)
+{
+    return Signed(x.get_sign() != y.get_sign(), MultiplyDigits(x.get_value(), y.get_value()));
+}
+// No leading zeros and no negative zero
+static bool NormalQ(const BigInt& x)
+{
+    const auto& v = x.get_value();
+    return !v.empty() && (v == "0" ? !x.get_sign() : v[0] != '0');
+}
+// floor(x / y) for y > 0, from the truncating division
+static BigInt FloorDivide(const BigInt& x, const BigInt& y)
+{
+    auto q = x / y;
+    if (x.get_sign() && q * y != x)
+        q -= BigInt("1");
+    return q;
+}
+
+// Restores the thresholds and the thread count changed by a test
+class TuningGuard
+{
+private:
+    BigIntTuning tuning = Tuning();
+    unsigned threads = ThreadCount();
+public:
+    ~TuningGuard()
+    {
+        SetTuning(tuning);
+        SetThreadCount(threads);
+    }
+};
+
+static void CheckArithmetic(const BigInt& x, const BigInt& y)
+{
+    auto sum = x + y, difference = x - y, product = x * y;
+    CHECK_EQ(sum, NaiveAdd(x, y));
+    CHECK_EQ(difference, NaiveSubtract(x, y));
+    CHECK_EQ(product, NaiveMultiply(x, y));
+    CHECK(NormalQ(sum) && NormalQ(difference) && NormalQ(product));
+    CHECK_EQ(x * x, NaiveMultiply(x, x));
+    auto z = RandomBigInt(static_cast<std::size_t>(Uniform(1, 30)));
+    auto a = z;
+    CHECK_EQ(AddMul(a, x, y), NaiveAdd(z, product));
+    CHECK(NormalQ(a));
+    a = z;
+    CHECK_EQ(SubMul(a, x, y), NaiveSubtract(z, product));
+    CHECK(NormalQ(a));
+    // The accumulator is also a factor
+    a = x;
+    CHECK_EQ(AddMul(a, a, y), NaiveAdd(x, product));
+    a = x;
+    CHECK_EQ(SubMul(a, y, a), NaiveSubtract(x, product));
+    a = x;
+    a += a;
+    CHECK_EQ(a, NaiveAdd(x, x));
+    a = x;
+    a -= a;
+    CHECK_EQ(a, BigInt());
+    a = x;
+    a *= a;
+    CHECK_EQ(a, NaiveMultiply(x, x));
+}
+
+static void TestArithmetic()
+{
+    TuningGuard guard;
+    // Carries and borrows through whole runs of 9s and 0s
+    for (std::size_t k{1}; k <= 40; ++k)
+    {
+        auto p = PowerOfTen(k), nines = p - BigInt("1");
+        CHECK_EQ(nines.get_value(), std::string(k, '9'));
+        CHECK_EQ(nines + BigInt("1"), p);
+        CHECK_EQ(BigInt("-1") + p, nines);
+        CHECK_EQ(p - nines, BigInt("1"));
+        CHECK_EQ(nines - p, BigInt("-1"));
+        CHECK_EQ(p + p - p - p, BigInt());
+        CHECK(NormalQ(nines - nines));
+    }
+    const std::size_t sizes[] = {1, 2, 7, 8, 9, 10, 17, 18, 36, 40, 100, 300, 1000, 2500};
+    auto defaults = Tuning();
+    // Digit by digit products, base 10^9 schoolbook, and Karatsuba from 4 limbs with
+    // parallel splits from 200 digits on four threads
+    const BigIntTuning tunings[] = {
+        {100000, defaults.karatsuba_threshold, defaults.shift_multiply_threshold, defaults.parallel_threshold},
+        {1, 1000000, defaults.shift_multiply_threshold, defaults.parallel_threshold},
+        {1, 4, defaults.shift_multiply_threshold, 200},
+        defaults,
+    };
+    SetThreadCount(4);
+    for (const auto& t : tunings)
+    {
+        SetTuning(t);
+        for (auto n : sizes)
+            for (auto m : sizes)
+                CheckArithmetic(RandomBigInt(n), RandomBigInt(m));
+        CheckArithmetic(BigInt(), RandomBigInt(50));
+        CheckArithmetic(RandomBigInt(50), BigInt());
+    }
+}
+
+static void TestDivision()
+{
+    for (int i{}; i < 2000; ++i)
+    {
+        auto a = UniformSigned(-1000000000000, 1000000000000), b = UniformSigned(-1000000, 1000000);
+        if (b == 0)
+            continue;
+        auto x = FromInt(a), y = FromInt(b);
+        CHECK_EQ(x / y, FromInt(a / b));
+        // The remainder of two negative numbers keeps the behaviour of the original operator%
+        if (a >= 0 || b >= 0)
+            CHECK_EQ(x % y, FromInt(a % b));
+    }
+    const std::size_t sizes[] = {1, 5, 9, 10, 30, 100, 400, 1000};
+    for (auto n : sizes)
+        for (auto m : sizes)
+        {
+            auto x = RandomBigInt(n), y = RandomBigInt(m);
+            if (x.get_sign() && y.get_sign())
+                x = -x;
+            auto q = x / y, r = x % y;
+            CHECK(NormalQ(q) && NormalQ(r));
+            CHECK_EQ(NaiveAdd(NaiveMultiply(q, y), r), x);
+            CHECK(Abs(r) < Abs(y));
+            CHECK(r == BigInt() || r.get_sign() == x.get_sign());
+        }
+    // Quotients that truncate to zero are zero, not negative zero
+    CHECK_EQ(BigInt("-5") / BigInt("100"), BigInt());
+    CHECK_EQ(BigInt("5") / BigInt("-100"), BigInt());
+    CHECK_THROWS(std::runtime_error, BigInt("5") / BigInt());
+    CHECK_THROWS(std::runtime_error, BigInt("5") % BigInt());
+}
+
+static void TestNumberTheory()
+{
+    // GCD against plain Euclid, of numbers with a large common factor
+    for (auto n : {1, 5, 20, 100, 500})
+    {
+        auto g = RandomBigInt(static_cast<std::size_t>(n), false);
+        auto x = RandomBigInt(static_cast<std::size_t>(n)) * g, y = RandomBigInt(static_cast<std::size_t>(n / 2 + 1)) * g;
+        auto a = Abs(x), b = Abs(y);
+        while (b != BigInt())
+        {
+            auto r = a % b;
+            a = std::move(b);
+            b = std::move(r);
+        }
+        CHECK_EQ(GCD(x, y), a);
+        CHECK_EQ(GCD(y, x), a);
+        CHECK_EQ(LCM(x, y) * a, Abs(x * y));
+    }
+    for (int i{}; i < 500; ++i)
+    {
+        auto a = UniformSigned(-1000000000000, 1000000000000), b = UniformSigned(-1000000, 1000000);
+        CHECK_EQ(GCD(FromInt(a), FromInt(b)), FromInt(std::gcd(a, b)));
+    }
+    CHECK_EQ(GCD(BigInt(), BigInt()), BigInt());
+
+    // The integer square root is the largest s with s^2 <= n
+    for (std::size_t n{1}; n <= 600; n += n < 40 ? 1 : 37)
+    {
+        auto x = RandomBigInt(n, false);
+        for (const auto& y : {x, x * x, x * x - BigInt("1"), x * x + x + x})
+        {
+            auto s = ISqrt(y);
+            CHECK(s * s <= y && y < (s + BigInt("1")) * (s + BigInt("1")));
+        }
+    }
+    CHECK_EQ(ISqrt(BigInt()), BigInt());
+    CHECK_THROWS(std::domain_error, ISqrt(BigInt("-2")));
+
+    // Powers, factorials, Fibonacci numbers and binomials against their definitions
+    for (auto n : {1, 3, 12, 60})
+    {
+        auto x = RandomBigInt(static_cast<std::size_t>(n)), p = BigInt("1");
+        for (int k{}; k <= 25; ++k)
+        {
+            CHECK_EQ(Pow(x, k), p);
+            p = NaiveMultiply(p, x);
+        }
+    }
+    BigInt f("1");
+    for (int n{}; n <= 300; ++n)
+    {
+        if (n > 0)
+            f = NaiveMultiply(f, FromInt(n));
+        CHECK_EQ(Factorial(n), f);
+    }
+    BigInt a, b("1");
+    for (int n{}; n <= 1500; ++n)
+    {
+        CHECK_EQ(Fibonacci(n), a);
+        auto c = NaiveAdd(a, b);
+        a = std::move(b);
+        b = std::move(c);
+    }
+    std::vector<BigInt> row{BigInt("1")};
+    for (int n{}; n <= 120; ++n)
+    {
+        for (int k{}; k <= n; ++k)
+            CHECK_EQ(Binomial(n, k), row[static_cast<std::size_t>(k)]);
+        std::vector<BigInt> next(row.size() + 1, BigInt("1"));
+        for (std::size_t k{1}; k < row.size(); ++k)
+            next[k] = NaiveAdd(row[k - 1], row[k]);
+        row = std::move(next);
+    }
+
+    // MulMod follows the sign rules of operator%, for either sign of the modulus
+    for (int i{}; i < 200; ++i)
+    {
+        auto x = RandomBigInt(Uniform(1, 60)), y = RandomBigInt(Uniform(1, 60)), m = RandomBigInt(Uniform(1, 40));
+        CHECK_EQ(MulMod(x, y, m), NaiveMultiply(x, y) % m);
+    }
+    CHECK_EQ(MulMod(BigInt("-2"), BigInt("3"), BigInt("-5")), BigInt("1"));
+    CHECK_EQ(MulMod(BigInt("-2"), BigInt("3"), BigInt("5")), BigInt("-1"));
+    for (std::size_t n{1}; n <= 100; ++n)
+    {
+        auto x = RandomBigInt(n);
+        CHECK_EQ(IntegerLength(x), n);
+        CHECK(EvenQ(x) == ((x.get_value().back() - '0') % 2 == 0));
+        CHECK(OddQ(x) != EvenQ(x));
+    }
+
+    // Harmonic numbers against a sum of fractions
+    BigFrac h;
+    for (int n{1}; n <= 200; ++n)
+    {
+        h += BigFrac(BigInt("1"), FromInt(n));
+        CHECK_EQ(Harmonic(n), h);
+    }
+}
+
+static void TestBitwise()
+{
+    for (int i{}; i < 3000; ++i)
+    {
+        auto a = UniformSigned(-(1ll << 40), 1ll << 40), b = UniformSigned(-(1ll << 40), 1ll << 40);
+        auto k = static_cast<int>(Uniform(0, 20));
+        auto x = FromInt(a), y = FromInt(b);
+        CHECK_EQ(x & y, FromInt(a & b));
+        CHECK_EQ(x | y, FromInt(a | b));
+        CHECK_EQ(BitXor(x, y), FromInt(a ^ b));
+        CHECK_EQ(~x, FromInt(~a));
+        CHECK_EQ(x << k, FromInt(a * (1ll << k)));
+        // An arithmetic shift, the floor of the quotient
+        CHECK_EQ(x >> k, FromInt(a >= 0 ? a / (1ll << k) : -((-a + (1ll << k) - 1) / (1ll << k))));
+        CHECK(TestBit(x, k + 20) == (((a >> (k + 20)) & 1) != 0));
+        auto u = static_cast<unsigned long long>(a < 0 ? -a : a);
+        std::size_t bits{}, ones{};
+        for (auto v = u; v != 0; v >>= 1)
+        {
+            ++bits;
+            ones += v & 1;
+        }
+        CHECK_EQ(BitLength(Abs(x)), bits);
+        CHECK_EQ(PopCount(Abs(x)), ones);
+    }
+    // Identities of the two's complement on multi-limb values, with shifts on both sides
+    // of the threshold where a shift becomes a product
+    for (auto n : {30, 200, 1500})
+    {
+        auto x = RandomBigInt(static_cast<std::size_t>(n)), y = RandomBigInt(static_cast<std::size_t>(n / 3 + 1));
+        CHECK_EQ((x & y) + (x | y), x + y);
+        CHECK_EQ(BitXor(x, y), (x | y) - (x & y));
+        CHECK_EQ(~x, -x - BigInt("1"));
+        for (int k : {1, 31, 64, 100, 1000, 5000})
+        {
+            auto p = Pow(BigInt("2"), k);
+            CHECK_EQ(x << k, NaiveMultiply(x, p));
+            CHECK_EQ(x >> k, FloorDivide(x, p));
+            CHECK_EQ((x << k) >> k, x);
+        }
+    }
+    // Values long enough for the divide and conquer conversion to words, and right shifts
+    // on both sides of the point where they go through words
+    auto x = RandomBigInt(20000), y = RandomBigInt(15000);
+    CHECK_EQ(x | BigInt(), x);
+    CHECK_EQ((x & y) + (x | y), x + y);
+    CHECK_EQ(PopCount(Abs(x) & Abs(y)) + PopCount(Abs(x) | Abs(y)), PopCount(Abs(x)) + PopCount(Abs(y)));
+    auto bits = static_cast<int>(BitLength(Abs(x)));
+    CHECK(Pow(BigInt("2"), bits - 1) <= Abs(x) && Abs(x) < Pow(BigInt("2"), bits));
+    for (int k : {0, 1, 33, 1000, 40000, bits - 1, bits + 100})
+    {
+        auto low = x & ((BigInt("1") << k) - BigInt("1"));
+        CHECK_EQ(((x >> k) << k) + low, x);
+        CHECK(TestBit(x, k) == OddQ(x >> k));
+    }
+}
+
+// The digits of x in base b, by repeated division
+static std::string NaiveDigits(const BigInt& x, const int b)
+{
+    if (x == BigInt())
+        return "0";
+    std::string s;
+    auto base = FromInt(b), y = Abs(x);
+    while (y != BigInt())
+    {
+        auto d = std::stoi((y % base).get_value());
+        s.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[d]);
+        y /= base;
+    }
+    if (x.get_sign())
+        s.push_back('-');
+    std::reverse(s.begin(), s.end());
+    return s;
+}
+
+static void TestText()
+{
+    std::vector<char> buffer(4096);
+    for (int b{2}; b <= 36; ++b)
+        for (auto n : {1, 2, 9, 30, 120, 300})
+        {
+            auto x = RandomBigInt(static_cast<std::size_t>(n));
+            auto s = NaiveDigits(x, b);
+            auto r = ToChars(buffer.data(), buffer.data() + buffer.size(), x, b);
+            CHECK(r.ec == std::errc());
+            CHECK_EQ(std::string(buffer.data(), r.ptr), s);
+            CHECK(FormattedSize(x, b) >= s.length());
+            BigInt y;
+            auto p = FromChars(s.data(), s.data() + s.length(), y, b);
+            CHECK(p.ec == std::errc() && p.ptr == s.data() + s.length());
+            CHECK_EQ(y, x);
+            std::string upper(s);
+            std::transform(upper.begin(), upper.end(), upper.begin(), [](const char c){return static_cast<char>(std::toupper(c));});
+            CHECK_EQ(BigInt(upper, b), x);
+        }
+    auto x = RandomBigInt(500);
+    CHECK_EQ(FormattedSize(x), x.get_value().length() + (x.get_sign() ? 1 : 0));
+    char small[10];
+    CHECK(ToChars(small, small + sizeof(small), x).ec == std::errc::value_too_large);
+
+    // Parse errors leave the value unchanged, and parsing stops at the first non-digit
+    for (const char* s : {"", "-", "+", "   ", "z", "-x1"})
+    {
+        BigInt y("17");
+        std::string t(s);
+        CHECK(FromChars(t.data(), t.data() + t.length(), y).ec == std::errc::invalid_argument);
+        CHECK_EQ(y, BigInt("17"));
+    }
+    std::string t("  -123abc");
+    BigInt y;
+    auto r = FromChars(t.data(), t.data() + t.length(), y);
+    CHECK(r.ec == std::errc() && r.ptr == t.data() + 6);
+    CHECK_EQ(y, BigInt("-123"));
+    CHECK_THROWS(std::invalid_argument, BigInt("12a"));
+    CHECK_THROWS(std::invalid_argument, BigInt("", 10));
+
+    // Format specifications
+    auto format = [](const char* spec, const BigInt& z)
+    {
+        FormatSpec f;
+        std::string s(spec);
+        ParseFormatSpec(s.data(), s.data() + s.length(), f);
+        std::string out(FormattedSize(z, f), '\0');
+        auto e = ToChars(&out[0], &out[0] + out.length(), z, f);
+        return std::string(&out[0], e.ptr);
+    };
+    CHECK_EQ(format(",", Factorial(20)), std::string("2,432,902,008,176,640,000"));
+    CHECK_EQ(format("+", BigInt("5")), std::string("+5"));
+    CHECK_EQ(format(">8x", BigInt("-255")), std::string("     -ff"));
+    CHECK_EQ(format("08", BigInt("-42")), std::string("-0000042"));
+    // Zero padding continues the groups, and never starts with a separator, as in Python
+    CHECK_EQ(format("011,", BigInt("1234567")), std::string("001,234,567"));
+    CHECK_EQ(format("012,", BigInt("1234567")), std::string("0,001,234,567"));
+    CHECK_EQ(format("012,", BigInt("-1234567")), std::string("-001,234,567"));
+    CHECK_EQ(format("010_x", BigInt("11259375")), std::string("0_00ab_cdef"));
+    for (const char* spec : {"011,", "012,", "013,", "+014_"})
+    {
+        FormatSpec f;
+        std::string t(spec);
+        ParseFormatSpec(t.data(), t.data() + t.length(), f);
+        CHECK_EQ(FormattedSize(BigInt("1234567"), f), format(spec, BigInt("1234567")).length());
+    }
+    std::ostringstream out;
+    out << x;
+    CHECK_EQ(out.str(), NaiveDigits(x, 10));
+}
+
+static std::string Binary(const BigInt& x)
+{
+    std::string s(BinarySize(x), '\0');
+    CHECK(WriteBinary(&s[0], x) == &s[0] + s.length());
+    return s;
+}
+
+static void TestBinary()
+{
+    std::string all;
+    std::vector<BigInt> values{BigInt(), BigInt("-1"), BigInt("999999999"), BigInt("1000000000"), BigInt("-1000000000000000000")};
+    for (auto n : {1, 9, 10, 100, 1000, 20000})
+        values.push_back(RandomBigInt(static_cast<std::size_t>(n)));
+    for (const auto& x : values)
+    {
+        auto s = Binary(x);
+        std::istringstream in(s);
+        CHECK_EQ(ReadBigInt(in), x);
+        BigIntView v(s.data(), s.data() + s.length());
+        CHECK(v.get_end() == s.data() + s.length());
+        CHECK_EQ(BigInt(v), x);
+        CHECK_EQ(IntegerLength(v), IntegerLength(x));
+        CHECK(EvenQ(v) == EvenQ(x) && OddQ(v) == OddQ(x));
+        all += s;
+    }
+    // Views read back to back, with arithmetic and comparisons on the stored limbs
+    std::vector<BigIntView> views;
+    for (const char* p = all.data(); p != all.data() + all.length(); p = views.back().get_end())
+        views.emplace_back(p, all.data() + all.length());
+    CHECK(views.size() == values.size());
+    for (std::size_t i{}; i < values.size(); ++i)
+        for (std::size_t j{}; j < values.size(); ++j)
+        {
+            const auto &x = values[i], &y = values[j];
+            const auto &v = views[i], &w = views[j];
+            CHECK_EQ(v + w, x + y);
+            CHECK_EQ(v - w, x - y);
+            CHECK_EQ(v * w, x * y);
+            CHECK((v < w) == (x < y) && (v == w) == (x == y) && (v >= w) == (x >= y));
+        }
+    BigFrac f(RandomBigInt(300), RandomBigInt(200, false));
+    std::ostringstream out;
+    WriteBinary(out, f);
+    CHECK_EQ(out.str().length(), BinarySize(f));
+    std::istringstream in(out.str());
+    CHECK_EQ(ReadBigFrac(in), f);
+
+    // Malformed data: a bad version, a truncated body, a limb of 10^9, a leading zero limb,
+    // a negative zero and a varint longer than 64 bits
+    auto corrupt = [](const std::string& s)
+    {
+        std::istringstream in(s);
+        CHECK_THROWS(std::invalid_argument, ReadBigInt(in));
+        CHECK_THROWS(std::invalid_argument, BigIntView(s.data(), s.data() + s.length()));
+    };
+    auto s = Binary(BigInt("123456789123456789"));
+    auto bad = s;
+    bad[0] = 2;
+    corrupt(bad);
+    corrupt(s.substr(0, s.length() - 1));
+    corrupt(s.substr(0, 1));
+    bad = s;
+    bad[2] = '\x00';
+    bad[3] = '\xCA';
+    bad[4] = '\x9A';
+    bad[5] = '\x3B'; // 10^9 = 0x3B9ACA00
+    corrupt(bad);
+    bad = s;
+    bad.replace(6, 4, std::string(4, '\0'));
+    corrupt(bad);
+    corrupt(std::string("\x01\x01", 2));
+    corrupt(std::string("\x01\x80\x80\x80\x80\x80\x80\x80\x80\x80\x02", 11));
+    corrupt(std::string("\x01\x80\x80\x80\x80\x80\x80\x80\x80\x80\x80\x00", 12));
+}
+
+// Primes below 20000 by the sieve of Eratosthenes
+static std::vector<bool> Sieve(const std::size_t n)
+{
+    std::vector<bool> prime(n, true);
+    prime[0] = prime[1] = false;
+    for (std::size_t p{2}; p * p < n; ++p)
+        if (prime[p])
+            for (auto k = p * p; k < n; k += p)
+                prime[k] = false;
+    return prime;
+}
+
+static void TestPrimes()
+{
+    const std::size_t LIMIT = 20000;
+    auto prime = Sieve(LIMIT);
+    for (std::size_t n{}; n < LIMIT; ++n)
+        CHECK(PrimeQ(FromInt(static_cast<long long>(n))) == prime[n]);
+    for (std::size_t n{}; n + 1 < LIMIT; n += 7)
+    {
+        auto next = n + 1;
+        while (!prime[next])
+            ++next;
+        if (next < LIMIT)
+            CHECK_EQ(NextPrime(FromInt(static_cast<long long>(n))), FromInt(static_cast<long long>(next)));
+        if (n > 2)
+        {
+            auto previous = n - 1;
+            while (!prime[previous])
+                --previous;
+            CHECK_EQ(PrevPrime(FromInt(static_cast<long long>(n))), FromInt(static_cast<long long>(previous)));
+        }
+    }
+    CHECK(!PrimeQ(BigInt("-7")));
+    CHECK_THROWS(std::domain_error, PrevPrime(BigInt("2")));
+
+    // Mersenne primes and the primes next to 10^20
+    BigInt two("2"), one("1");
+    for (int p : {61, 89, 107, 127, 521, 607})
+        CHECK(PrimeQ(Pow(two, p) - one));
+    for (int p : {67, 101, 257})
+        CHECK(!PrimeQ(Pow(two, p) - one));
+    CHECK_EQ(NextPrime(PowerOfTen(20)), BigInt("100000000000000000039"));
+    CHECK_EQ(PrevPrime(PowerOfTen(20)), BigInt("99999999999999999989"));
+    CHECK(PrimeQ(BigInt("170141183460469231731687303715884105727"), 5));
+
+    // Carmichael numbers, strong pseudoprimes to base 2 and small bases, strong Lucas
+    // pseudoprimes, squares of primes and products of large primes
+    for (const char* n : {"561", "1105", "41041", "825265", "321197185", "5394826801", "232250619601",
+                          "9746347772161", "2047", "3277", "4033", "4681", "8321", "3215031751",
+                          "2152302898747", "3474749660383", "341550071728321", "3825123056546413051",
+                          "5459", "5777", "10877", "16109", "18971", "1000006000009", "1000000016000000063"})
+        CHECK(!PrimeQ(BigInt(n)));
+    CHECK(!PrimeQ((Pow(two, 61) - one) * (Pow(two, 89) - one)));
+    auto p = NextPrime(PowerOfTen(30));
+    CHECK(!PrimeQ(p * p));
+    CHECK(!PrimeQ(p * NextPrime(p)));
+
+    // PowerMod against a power reduced into [0, |m|), for odd and even moduli
+    for (int i{}; i < 300; ++i)
+    {
+        auto x = RandomBigInt(Uniform(1, 30)), m = RandomBigInt(Uniform(1, 25));
+        auto e = static_cast<int>(Uniform(0, 60));
+        auto r = Pow(x, e) % Abs(m);
+        if (r.get_sign())
+            r += Abs(m);
+        CHECK_EQ(PowerMod(x, FromInt(e), m), r);
+    }
+    CHECK_EQ(PowerMod(BigInt("5"), BigInt(), BigInt("1")), BigInt());
+    CHECK_EQ(PowerMod(BigInt("-3"), BigInt("5"), BigInt("-7")), BigInt("2"));
+    CHECK_THROWS(std::domain_error, PowerMod(two, BigInt("-1"), BigInt("7")));
+    for (int k : {127, 521})
+    {
+        auto q = Pow(two, k) - one;
+        CHECK_EQ(PowerMod(BigInt("3"), q - one, q), one);
+    }
+
+    // RandomBelow covers [0, n) evenly and repeats after SeedRandom
+    int counts[10]{};
+    for (int i{}; i < 10000; ++i)
+    {
+        auto r = RandomBelow(BigInt("10"));
+        CHECK(r >= BigInt() && r < BigInt("10"));
+        ++counts[std::stoi(r.get_value())];
+    }
+    for (auto c : counts)
+        CHECK(c > 850 && c < 1150);
+    auto n = PowerOfTen(50) + BigInt("7");
+    SeedRandom(42);
+    auto first = RandomBelow(n), second = RandomBelow(n);
+    SeedRandom(42);
+    CHECK_EQ(RandomBelow(n), first);
+    CHECK_EQ(RandomBelow(n), second);
+    for (int i{}; i < 100; ++i)
+    {
+        auto r = RandomBelow(n);
+        CHECK(r >= BigInt() && r < n);
+    }
+}
+
+// The factors of n by trial division
+static std::vector<std::pair<BigInt, int>> TrialFactors(long long n)
+{
+    std::vector<std::pair<BigInt, int>> f;
+    if (n < 0)
+    {
+        f.emplace_back(BigInt("-1"), 1);
+        n = -n;
+    }
+    for (long long p{2}; p * p <= n; ++p)
+    {
+        int k{};
+        for (; n % p == 0; n /= p)
+            ++k;
+        if (k > 0)
+            f.emplace_back(FromInt(p), k);
+    }
+    if (n > 1)
+        f.emplace_back(FromInt(n), 1);
+    return f;
+}
+
+static void CheckFactors(const BigInt& n, const std::vector<std::pair<BigInt, int>>& f)
+{
+    BigInt product("1");
+    for (std::size_t i{}; i < f.size(); ++i)
+    {
+        const auto& p = f[i].first;
+        CHECK(f[i].second > 0);
+        if (i == 0 && p == BigInt("-1"))
+        {
+            CHECK(n.get_sign() && f[i].second == 1);
+            product = -product;
+            continue;
+        }
+        CHECK(PrimeQ(p));
+        CHECK(i == 0 || f[i - 1].first < p);
+        product *= Pow(p, f[i].second);
+    }
+    CHECK_EQ(product, n);
+}
+
+static void TestFactorInteger()
+{
+    using Factors = std::vector<std::pair<BigInt, int>>;
+    CHECK(FactorInteger(BigInt()) == Factors{{BigInt(), 1}});
+    CHECK(FactorInteger(BigInt("1")) == Factors{{BigInt("1"), 1}});
+    CHECK(FactorInteger(BigInt("-360")) == Factors{{BigInt("-1"), 1}, {BigInt("2"), 3}, {BigInt("3"), 2}, {BigInt("5"), 1}});
+    for (int i{}; i < 100; ++i)
+    {
+        auto n = UniformSigned(2, 1000000000000) * (Uniform(0, 1) == 1 ? -1 : 1);
+        auto x = FromInt(n);
+        auto f = FactorInteger(x);
+        CHECK(f == TrialFactors(n));
+        CheckFactors(x, f);
+    }
+    // The Fermat number 2^64 + 1, and semiprimes left to Pollard-Brent rho and the elliptic
+    // curve method
+    auto f = FactorInteger(Pow(BigInt("2"), 64) + BigInt("1"));
+    CHECK(f == Factors{{BigInt("274177"), 1}, {BigInt("67280421310721"), 1}});
+    SeedRandom(7);
+    for (auto digits : {9, 11, 14})
+    {
+        auto p = NextPrime(PowerOfTen(static_cast<std::size_t>(digits))), q = NextPrime(PowerOfTen(24));
+        CHECK(FactorInteger(p * q * BigInt("1024")) == Factors{{BigInt("2"), 10}, {p, 1}, {q, 1}});
+    }
+    auto r = NextPrime(PowerOfTen(7)), q = NextPrime(PowerOfTen(24));
+    CHECK(FactorInteger(r * r * q) == Factors{{r, 2}, {q, 1}});
+    auto n = Pow(BigInt("3"), 40) * NextPrime(PowerOfTen(12)) * NextPrime(PowerOfTen(13));
+    CheckFactors(n, FactorInteger(n));
+}
+
+// The quotients of plain Euclid on x = num / denom, the first one floored
+static std::vector<BigInt> EuclidQuotients(const BigFrac& x)
+{
+    auto a = x.get_numerator(), b = x.get_denominator();
+    std::vector<BigInt> q;
+    while (b != BigInt())
+    {
+        q.push_back(FloorDivide(a, b));
+        auto r = a - q.back() * b;
+        a = std::move(b);
+        b = std::move(r);
+    }
+    return q;
+}
+static BigFrac RandomFrac(const std::size_t n, const std::size_t m)
+{
+    return BigFrac(RandomBigInt(n), RandomBigInt(m, false));
+}
+
+static void TestFractions()
+{
+    // Sizes around the 64 digit leaves of the half-GCD and well above them
+    const std::size_t sizes[] = {1, 3, 20, 64, 65, 200, 700, 1500};
+    for (auto n : sizes)
+        for (auto m : sizes)
+        {
+            auto x = RandomFrac(n, m);
+            auto q = ContinuedFraction(x);
+            CHECK(q == EuclidQuotients(x));
+            CHECK_EQ(FromContinuedFraction(q), x);
+        }
+    auto golden = BigFrac(Fibonacci(3001), Fibonacci(3000));
+    auto ones = ContinuedFraction(golden);
+    CHECK(ones.size() == 2999 && std::count(ones.begin(), ones.end(), BigInt("1")) == 2998 && ones.back() == BigInt("2"));
+    CHECK(ContinuedFraction(BigFrac("-7", "3")) == std::vector<BigInt>{BigInt("-3"), BigInt("1"), BigInt("2")});
+    CHECK(ContinuedFraction(BigFrac("5", "1")) == std::vector<BigInt>{BigInt("5")});
+    CHECK_THROWS(std::domain_error, FromContinuedFraction({}));
+
+    // LimitDenominator is the closest fraction with a bounded denominator, found by trying
+    // every denominator
+    for (int i{}; i < 300; ++i)
+    {
+        auto p = UniformSigned(-10000000, 10000000), q = UniformSigned(1, 1000000);
+        auto bound = UniformSigned(1, 300);
+        BigFrac x(FromInt(p), FromInt(q));
+        auto y = LimitDenominator(x, FromInt(bound));
+        CHECK(y.get_denominator() <= FromInt(bound));
+        auto best = Abs(x - y);
+        for (long long d{1}; d <= bound; ++d)
+        {
+            auto k = FloorDivide(FromInt(p * d), FromInt(q));
+            for (const auto& c : {k, k + BigInt("1")})
+                CHECK(best <= Abs(x - BigFrac(c, FromInt(d))));
+        }
+    }
+    // On long fractions it is at least as close as the last convergent within the bound
+    for (auto n : {100, 1000})
+    {
+        auto x = RandomFrac(static_cast<std::size_t>(n), static_cast<std::size_t>(n));
+        auto bound = PowerOfTen(static_cast<std::size_t>(n / 4));
+        auto y = LimitDenominator(x, bound);
+        CHECK(y.get_denominator() <= bound);
+        BigInt h0("1"), h1, k0, k1("1");
+        BigFrac convergent;
+        for (const auto& a : EuclidQuotients(x))
+        {
+            auto h = a * h0 + h1, k = a * k0 + k1;
+            if (k > bound)
+                break;
+            convergent = BigFrac(h, k);
+            h1 = std::move(h0);
+            h0 = std::move(h);
+            k1 = std::move(k0);
+            k0 = std::move(k);
+        }
+        CHECK(Abs(x - y) <= Abs(x - convergent));
+    }
+    CHECK_EQ(LimitDenominator(BigFrac("1", "3"), BigInt("3")), BigFrac("1", "3"));
+    CHECK_THROWS(std::domain_error, LimitDenominator(BigFrac("1", "3"), BigInt()));
+
+    // Simplest is the fraction of smallest denominator in the closed interval, and of
+    // those the one closest to zero
+    for (int i{}; i < 2000; ++i)
+    {
+        auto a = UniformSigned(-30, 30), b = UniformSigned(1, 12), c = UniformSigned(-30, 30), d = UniformSigned(1, 12);
+        BigFrac lo(FromInt(a), FromInt(b)), hi(FromInt(c), FromInt(d));
+        if (hi < lo)
+            std::swap(lo, hi);
+        BigFrac expected;
+        for (long long q{1};; ++q)
+        {
+            auto first = -FloorDivide(-lo.get_numerator() * FromInt(q), lo.get_denominator());
+            auto last = FloorDivide(hi.get_numerator() * FromInt(q), hi.get_denominator());
+            if (first > last)
+                continue;
+            auto p = first > BigInt() ? first : last < BigInt() ? last : BigInt();
+            expected = BigFrac(p, FromInt(q));
+            break;
+        }
+        CHECK_EQ(Simplest(lo, hi), expected);
+        CHECK_EQ(Simplest(hi, lo), expected);
+    }
+
+    CHECK_EQ(BigFrac("2", "-4"), BigFrac("-1", "2"));
+    CHECK_EQ(Abs(BigFrac("-1", "3")), BigFrac("1", "3"));
+    CHECK_THROWS(std::runtime_error, BigFrac("1", "0"));
+}
+
+static void TestReductions()
+{
+    TuningGuard guard;
+    SetThreadCount(4);
+    std::vector<BigInt> values;
+    for (int i{}; i < 100; ++i)
+        values.push_back(RandomBigInt(Uniform(1, 60)));
+    BigInt product("1"), sum, lcm("1");
+    for (const auto& x : values)
+    {
+        product = NaiveMultiply(product, x);
+        sum = NaiveAdd(sum, x);
+    }
+    for (std::size_t i{}; i < 20; ++i)
+        lcm = LCM(lcm, values[i]);
+    CHECK_EQ(Product(values), product);
+    CHECK_EQ(Product(values.begin(), values.end()), product);
+    CHECK_EQ(Sum(values), sum);
+    CHECK_EQ(LCM(values.begin(), values.begin() + 20), lcm);
+    CHECK_EQ(Product(std::vector<BigInt>{}), BigInt("1"));
+    CHECK_EQ(Sum(std::vector<BigInt>{}), BigInt());
+
+    std::vector<BigInt> x, y, r(300);
+    for (int i{}; i < 300; ++i)
+    {
+        x.push_back(RandomBigInt(Uniform(1, 400)));
+        y.push_back(RandomBigInt(Uniform(1, 200), false));
+    }
+    AddN(x.data(), y.data(), r.data(), x.size());
+    for (std::size_t i{}; i < x.size(); ++i)
+        CHECK_EQ(r[i], NaiveAdd(x[i], y[i]));
+    MulN(x.data(), y.data(), r.data(), x.size());
+    for (std::size_t i{}; i < x.size(); ++i)
+        CHECK_EQ(r[i], NaiveMultiply(x[i], y[i]));
+    ModN(x.data(), y.data(), r.data(), x.size());
+    for (std::size_t i{}; i < x.size(); ++i)
+        CHECK_EQ(r[i], x[i] % y[i]);
+}
+
+static void TestCache()
+{
+    SetCacheLimit(0);
+    std::vector<BigInt> factorials, fibonaccis;
+    std::vector<BigFrac> harmonics;
+    const int arguments[] = {999, 1000, 1001, 2500, 4000, 4321};
+    for (auto n : arguments)
+    {
+        factorials.push_back(Factorial(n));
+        fibonaccis.push_back(Fibonacci(n));
+        harmonics.push_back(Harmonic(n));
+    }
+    // Lookups, resumed computations and preloaded checkpoints give the uncached values
+    SetCacheLimit(std::size_t{64} << 20);
+    for (int pass{}; pass < 2; ++pass)
+        for (std::size_t i{}; i < std::size(arguments); ++i)
+        {
+            CHECK_EQ(Factorial(arguments[i]), factorials[i]);
+            CHECK_EQ(Fibonacci(arguments[i]), fibonaccis[i]);
+            CHECK_EQ(Harmonic(arguments[i]), harmonics[i]);
+        }
+    auto info = CacheStatus();
+    CHECK(info.hits > 0 && info.bytes > 0 && info.bytes <= info.limit);
+    CHECK(info.largest[static_cast<std::size_t>(CacheFunction::Factorial)] == 4000);
+    PreloadCache(CacheFunction::Fibonacci, 10000);
+    CHECK(CacheStatus().checkpoints[static_cast<std::size_t>(CacheFunction::Fibonacci)] == 10);
+    CHECK_EQ(Fibonacci(4321), fibonaccis.back());
+    EvictCache(CacheFunction::Fibonacci);
+    CHECK(CacheStatus().checkpoints[static_cast<std::size_t>(CacheFunction::Fibonacci)] == 0);
+
+    // A small limit evicts while threads read and store checkpoints
+    SetCacheLimit(std::size_t{1} << 15);
+    std::atomic<int> wrong{};
+    std::vector<std::thread> threads;
+    for (int t{}; t < 4; ++t)
+        threads.emplace_back([&, t]
+        {
+            for (int i{}; i < 20; ++i)
+            {
+                auto k = static_cast<std::size_t>(t + i) % std::size(arguments);
+                if (Factorial(arguments[k]) != factorials[k] || Fibonacci(arguments[k]) != fibonaccis[k])
+                    ++wrong;
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    CHECK(wrong == 0);
+    info = CacheStatus();
+    CHECK(info.bytes <= info.limit);
+    EvictCache();
+    CHECK(CacheStatus().bytes == 0);
+    SetCacheLimit(0);
+}
+
+static void TestAsync()
+{
+    // Progress is reported on the computing thread and ends with 1
+    std::mutex m;
+    std::vector<double> progress;
+    auto record = [&](const double p)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        progress.push_back(p);
+    };
+    CHECK_EQ(FactorialAsync(5000, {}, record).get(), Factorial(5000));
+    CHECK(!progress.empty() && progress.back() == 1.0 && std::is_sorted(progress.begin(), progress.end()));
+    CHECK_EQ(FibonacciAsync(20000).get(), Fibonacci(20000));
+    auto x = RandomBigInt(50);
+    CHECK_EQ(PowAsync(x, 300).get(), Pow(x, 300));
+    CHECK_EQ(HarmonicAsync(500).get(), Harmonic(500));
+
+    // A stop condition that holds from the start cancels every computation
+    auto stop = []{return true;};
+    CHECK_THROWS(Cancelled, FactorialAsync(200000, stop).get());
+    CHECK_THROWS(Cancelled, FibonacciAsync(2000000, stop).get());
+    CHECK_THROWS(Cancelled, PowAsync(x, 100000, stop).get());
+    CHECK_THROWS(Cancelled, HarmonicAsync(100000, stop).get());
+
+    // A custom executor runs the calls
+    std::atomic<int> started{};
+    SetExecutor([&](std::function<void()> f)
+    {
+        ++started;
+        std::thread(std::move(f)).detach();
+    });
+    CHECK_EQ(FactorialAsync(100).get(), Factorial(100));
+    CHECK(started == 1);
+    SetExecutor({});
+}
+
+// x modulo 2^Bits in two's complement
+template <std::size_t Bits>
+static BigInt Wrap(const BigInt& x)
+{
+    auto m = Pow(BigInt("2"), static_cast<int>(Bits)), h = Pow(BigInt("2"), static_cast<int>(Bits - 1));
+    auto r = x % m;
+    if (r.get_sign())
+        r += m;
+    return r >= h ? r - m : r;
+}
+
+template <std::size_t Bits>
+static void CheckFixed()
+{
+    using Fixed = FixedBigInt<Bits>;
+    for (int i{}; i < 300; ++i)
+    {
+        auto x = Wrap<Bits>(RandomBigInt(Uniform(1, Bits / 3))), y = Wrap<Bits>(RandomBigInt(Uniform(1, Bits / 4)));
+        Fixed a(x), b(y);
+        CHECK_EQ(BigInt(a), x);
+        CHECK_EQ(BigInt(Fixed((x.get_sign() ? "-" : "") + x.get_value())), x);
+        CHECK_EQ(BigInt(a + b), Wrap<Bits>(x + y));
+        CHECK_EQ(BigInt(a - b), Wrap<Bits>(x - y));
+        CHECK_EQ(BigInt(a * b), Wrap<Bits>(x * y));
+        CHECK_EQ(BigInt(a & b), x & y);
+        CHECK_EQ(BigInt(a | b), x | y);
+        CHECK_EQ(BigInt(BitXor(a, b)), BitXor(x, y));
+        CHECK_EQ(BigInt(~a), ~x);
+        auto k = static_cast<int>(Uniform(0, Bits - 1));
+        CHECK_EQ(BigInt(a << k), Wrap<Bits>(x << k));
+        CHECK_EQ(BigInt(a >> k), x >> k);
+        CHECK((a < b) == (x < y) && (a == b) == (x == y));
+        if (y != BigInt())
+        {
+            // Truncating division, the remainder taking the sign of the dividend
+            auto q = Abs(x) / Abs(y);
+            if (x.get_sign() != y.get_sign())
+                q = -q;
+            CHECK_EQ(BigInt(a / b), Wrap<Bits>(q));
+            CHECK_EQ(BigInt(a % b), Wrap<Bits>(x - q * y));
+        }
+        CHECK_EQ(BigInt(GCD(a, b)), Wrap<Bits>(GCD(x, y)));
+        if (!Abs(a).get_sign())
+            CHECK_EQ(BigInt(ISqrt(Abs(a))), ISqrt(Abs(x)));
+        CHECK_EQ(a.get_value(), Abs(x).get_value());
+    }
+}
+
+static void TestFixed()
+{
+    CheckFixed<64>();
+    CheckFixed<128>();
+    CheckFixed<512>();
+    static_assert((FixedBigInt<128>(1) << 127) - 1 == FixedBigInt<128>("170141183460469231731687303715884105727"), "");
+    static_assert(FixedBigInt<64>(-7) / FixedBigInt<64>(2) == FixedBigInt<64>(-3), "");
+    static_assert(ISqrt(FixedBigInt<256>("1000000000000000000000000000000")) == FixedBigInt<256>("1000000000000000"), "");
+}
+
+// A scratch directory of its own, removed with all that is left in it
+class ScratchGuard
+{
+private:
+    std::string previous = ScratchDirectory();
+    std::size_t memory = FileMemory();
+public:
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("bigint_test_" + std::to_string(rng()));
+
+    ScratchGuard()
+    {
+        std::filesystem::create_directories(path);
+        SetScratchDirectory(path.string());
+    }
+    ~ScratchGuard()
+    {
+        SetScratchDirectory(previous);
+        SetFileMemory(memory);
+        std::error_code e;
+        std::filesystem::remove_all(path, e);
+    }
+    std::size_t Files() const
+    {
+        return static_cast<std::size_t>(std::distance(std::filesystem::directory_iterator(path), std::filesystem::directory_iterator()));
+    }
+};
+
+static void CheckFile(const BigInt& x, const BigInt& y)
+{
+    BigIntFile a(x), b(y);
+    CHECK_EQ(BigInt(a), x);
+    CHECK_EQ(IntegerLength(a), IntegerLength(x));
+    CHECK_EQ(BigInt(a + b), x + y);
+    CHECK_EQ(BigInt(a - b), x - y);
+    CHECK_EQ(BigInt(a * b), x * y);
+}
+
+static void TestFile()
+{
+    ScratchGuard scratch;
+    TuningGuard guard;
+    SetThreadCount(4);
+    // Sums, differences and block products, and a zero without a file
+    for (auto n : {1, 9, 10, 1000, 30000})
+        for (auto m : {1, 10, 5000})
+            CheckFile(RandomBigInt(static_cast<std::size_t>(n)), RandomBigInt(static_cast<std::size_t>(m)));
+    CheckFile(BigInt(), RandomBigInt(100));
+    auto x = RandomBigInt(40000);
+    CheckFile(x, -x);
+    CHECK(BigIntFile(BigInt()).get_path().empty());
+
+    // Transforms of at least 4096 limbs, in memory and then in four steps through the file
+    // with 1 MiB of buffers
+    auto y = RandomBigInt(45000), z = RandomBigInt(38000);
+    CheckFile(y, z);
+    {
+        BigIntFile a(y);
+        CHECK_EQ(BigInt(a * a), y * y);
+    }
+    SetFileMemory(1);
+    CHECK(FileMemory() == std::size_t{1} << 20);
+    y = RandomBigInt(200000);
+    z = RandomBigInt(250000);
+    CheckFile(y, z);
+    {
+        BigIntFile a(y);
+        CHECK_EQ(BigInt(a * a), y * y);
+    }
+    CheckFile(RandomBigInt(400000), RandomBigInt(9));
+
+    // Files written by WriteBinary are used in place and kept, printed and written back
+    auto file = (scratch.path / "x.bin").string();
+    {
+        std::ofstream out(file, std::ios::binary);
+        WriteBinary(out, y);
+    }
+    {
+        auto a = BigIntFile::Open(file);
+        CHECK(a.get_path() == file && a.get_sign() == y.get_sign());
+        std::ostringstream text, binary;
+        text << a;
+        CHECK_EQ(text.str(), (y.get_sign() ? "-" : "") + y.get_value());
+        WriteBinary(binary, a * a);
+        std::istringstream in(binary.str());
+        CHECK_EQ(ReadBigInt(in), y * y);
+    }
+    CHECK(std::filesystem::exists(file));
+    std::filesystem::remove(file);
+    CHECK_THROWS(std::runtime_error, BigIntFile::Open(file));
+    // Every temporary file is gone with its BigIntFile
+    CHECK(scratch.Files() == 0);
+}
+
+struct Group
+{
+    const char* name;
+    void (*run)();
+};
+
+static const Group GROUPS[] = {
+    {"arithmetic", TestArithmetic},
+    {"division", TestDivision},
+    {"number", TestNumberTheory},
+    {"bitwise", TestBitwise},
+    {"primes", TestPrimes},
+    {"factor", TestFactorInteger},
+    {"fractions", TestFractions},
+    {"text", TestText},
+    {"binary", TestBinary},
+    {"reductions", TestReductions},
+    {"cache", TestCache},
+    {"async", TestAsync},
+    {"fixed", TestFixed},
+    {"file", TestFile},
+};
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> names(argv + 1, argv + argc);
+    for (const auto& name : names)
+        if (std::none_of(std::begin(GROUPS), std::end(GROUPS), [&](const Group& g){return name == g.name;}))
+        {
+            std::cerr << "usage: bigint_test [GROUP...]\ngroups:";
+            for (const auto& g : GROUPS)
+                std::cerr << " " << g.name;
+            std::cerr << "\n";
+            return 2;
+        }
+    for (const auto& g : GROUPS)
+    {
+        if (!names.empty() && std::find(names.begin(), names.end(), g.name) == names.end())
+            continue;
+        auto before = failures;
+        try
+        {
+            g.run();
+        }
+        catch (const std::exception& e)
+        {
+            ++failures;
+            std::cerr << g.name << ": unexpected exception: " << e.what() << "\n";
+        }
+        std::cout << g.name << ": " << (failures == before ? "passed" : "FAILED") << "\n";
+    }
+    std::cout << checks << " checks, " << failures << " failed\n";
+    return failures == 0 ? 0 : 1;
+}